@@ -1,8 +1,10 @@
 import { checkFAType } from "../utils/checkFAType.js";
 import { generateAutomatonDOT } from "../utils/generateDOT.js";
-import { testInputStringWithCpp } from "../utils/InputString.js";
+import { testInputStringWithCpp, testInputStringsWithCpp } from "../utils/InputString.js";
 import { minimizeDFA } from "../utils/DFAMinimizer.js";
 import { convertNFAtoDFA } from "../utils/NFAtoDFA.js";
+import { removeEpsilon } from "../utils/removeEpsilon.js";
+import { runCommand } from "../utils/workerPool.js";
 import { getDatabase } from "../database/db.js";
 
 export const checkFATypeHandler = async (req, res) => {
@@ -31,16 +33,28 @@ export const testInputStringHandler = async (req, res) => {
     console.log("Received string validation request:", req.body);
 
     try {
-        const { transitions, start_state, end_states, input } = req.body;
+        const { transitions, start_state, end_states, input, inputs, include_path } = req.body;
 
         // Validate input
-        if (!transitions || !start_state || !end_states || input === undefined) {
+        if (!transitions || !start_state || !end_states || (input === undefined && !Array.isArray(inputs))) {
             return res.status(400).json({
                 success: false,
                 error: "Missing required fields: transitions, start_state, end_states, input"
             });
         }
 
+        // Batch mode: validate every string in one C++ process
+        if (Array.isArray(inputs)) {
+            const batchResult = await testInputStringsWithCpp({
+                transitions,
+                start_state,
+                end_states,
+                inputs,
+                include_path
+            });
+            return res.json(batchResult);
+        }
+
         const cppResult = await testInputStringWithCpp({
             transitions,
             start_state,
@@ -106,6 +120,197 @@ export const convertNFAtoDFAHandler = async (req, res) => {
     }
 };
 
+export const removeEpsilonHandler = async (req, res) => {
+    try {
+        const { transitions, start_state, end_states, symbols } = req.body;
+        if (!transitions || !start_state || !end_states || !symbols) {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: transitions, start_state, end_states, symbols"
+            });
+        }
+
+        const result = await removeEpsilon(req.body);
+        res.json(result);
+    } catch (err) {
+        console.error("Error in removeEpsilonHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
+export const pipelineHandler = async (req, res) => {
+    try {
+        const { transitions, start_state, end_states, steps } = req.body;
+        if (!transitions || !start_state || !end_states || !Array.isArray(steps)) {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: transitions, start_state, end_states, steps"
+            });
+        }
+
+        const result = await runCommand("pipeline", req.body);
+        res.status(result.success ? 200 : 400).json(result);
+    } catch (err) {
+        console.error("Error in pipelineHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
+export const searchHandler = async (req, res) => {
+    try {
+        const { transitions, start_state, end_states, text } = req.body;
+        if (!transitions || !start_state || !end_states || typeof text !== "string") {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: transitions, start_state, end_states, text"
+            });
+        }
+
+        const result = await runCommand("search", req.body);
+        res.status(result.success ? 200 : 400).json(result);
+    } catch (err) {
+        console.error("Error in searchHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
+// A saved row in the engine's request format
+const rowToAutomaton = (row) => ({
+    id: row.id,
+    symbols: JSON.parse(row.symbols),
+    start_state: row.start_state,
+    end_states: JSON.parse(row.end_states),
+    transitions: JSON.parse(row.transitions)
+});
+
+// Runs saved automata (the given ids, else all of them) against the inputs in one pass
+export const matchAllHandler = async (req, res) => {
+    try {
+        const { ids, input, inputs } = req.body;
+        if (input === undefined && inputs === undefined) {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: input or inputs"
+            });
+        }
+        if (ids !== undefined && (!Array.isArray(ids) || ids.length === 0)) {
+            return res.status(400).json({
+                success: false,
+                error: "ids must be a non-empty array; omit it to match against every automaton"
+            });
+        }
+
+        // Repeated ids name the same row, e.g. [1, 1] or [1, "1"]
+        const wanted = Array.isArray(ids) ? [...new Map(ids.map((id) => [String(id), id])).values()] : null;
+
+        const db = await getDatabase();
+        const rows = wanted
+            ? await db.all(
+                `SELECT * FROM automata WHERE id IN (${wanted.map(() => "?").join(", ")})`,
+                wanted
+            )
+            : await db.all(`SELECT * FROM automata`);
+
+        const found = new Set(rows.map((row) => row.id));
+        const missing = wanted ? wanted.filter((id) => !found.has(Number(id))) : [];
+        if (missing.length > 0) {
+            return res.status(404).json({
+                success: false,
+                error: `Automaton not found: ${missing.join(", ")}`
+            });
+        }
+
+        const patterns = rows.map(rowToAutomaton);
+
+        const { ids: _ids, ...request } = req.body;
+        const result = await runCommand("match-all", { ...request, patterns });
+        res.status(result.success ? 200 : 400).json(result);
+    } catch (err) {
+        console.error("Error in matchAllHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
+// Runs a two-automaton command whose "left" and "right" are each given
+// inline or as the id of a saved automaton
+const runOnPair = async (command, req, res) => {
+    const { left, right } = req.body;
+    if (left === null || right === null) {
+        return res.status(400).json({
+            success: false,
+            error: "left and right must each be an automaton or the id of a saved one"
+        });
+    }
+    const db = await getDatabase();
+    const resolve = async (side) => {
+        if (typeof side === "object") return side;
+        const row = await db.get(`SELECT * FROM automata WHERE id = ?`, [side]);
+        return row ? rowToAutomaton(row) : null;
+    };
+    const [leftAutomaton, rightAutomaton] = await Promise.all([resolve(left), resolve(right)]);
+    if (!leftAutomaton || !rightAutomaton) {
+        return res.status(404).json({
+            success: false,
+            error: `Automaton not found: ${!leftAutomaton ? left : right}`
+        });
+    }
+
+    const result = await runCommand(command, {
+        ...req.body,
+        left: leftAutomaton,
+        right: rightAutomaton
+    });
+    res.status(result.success ? 200 : 400).json(result);
+};
+
+export const productHandler = async (req, res) => {
+    try {
+        const { left, right, operation } = req.body;
+        if (left === undefined || right === undefined || !operation) {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: left, right, operation"
+            });
+        }
+        await runOnPair("product", req, res);
+    } catch (err) {
+        console.error("Error in productHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
+export const equivalentHandler = async (req, res) => {
+    try {
+        const { left, right } = req.body;
+        if (left === undefined || right === undefined) {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: left, right"
+            });
+        }
+        await runOnPair("equivalent", req, res);
+    } catch (err) {
+        console.error("Error in equivalentHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
+export const inclusionHandler = async (req, res) => {
+    try {
+        const { left, right } = req.body;
+        if (left === undefined || right === undefined) {
+            return res.status(400).json({
+                success: false,
+                error: "Missing required fields: left, right"
+            });
+        }
+        await runOnPair("inclusion", req, res);
+    } catch (err) {
+        console.error("Error in inclusionHandler:", err);
+        res.status(500).json({ success: false, error: err.message });
+    }
+};
+
 export const saveAutomatonHandler = async (req, res) => {
     try {
         const { name, states, symbols, startState, finalStates, transitions } = req.body;
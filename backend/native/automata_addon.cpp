@@ -0,0 +1,255 @@
+#include <node_api.h>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <utility>
+#include "../../cpp/core/Commands.hpp"
+
+// In-process binding of the automata engine.
+//
+// Exposes the request handlers of cpp/core/Commands.hpp as promise-returning
+// functions, e.g. `await addon.minimize({transitions, ...})`. Arguments are
+// converted straight from JS values to json on the main thread, the command
+// runs on the libuv threadpool, and the response is converted straight back,
+// so no text JSON is produced on either side. Results have the same shape as
+// the `automata --serve` worker: handler errors resolve to
+// {"success": false, "error": ...} rather than rejecting.
+
+using json = nlohmann::json;
+
+namespace {
+
+#define NAPI_CALL(env, call)                                        \
+    do {                                                            \
+        if ((call) != napi_ok) {                                    \
+            napi_throw_error((env), nullptr, "N-API call failed: " #call); \
+            return nullptr;                                         \
+        }                                                           \
+    } while (0)
+
+// JS value -> json. Functions, symbols and other non-JSON values become null,
+// except as object properties, which are left out as JSON.stringify does.
+json toJson(napi_env env, napi_value value) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+
+    switch (type) {
+    case napi_boolean: {
+        bool b;
+        napi_get_value_bool(env, value, &b);
+        return b;
+    }
+    case napi_number: {
+        double d;
+        napi_get_value_double(env, value, &d);
+        // Casting NaN, infinities or values outside int64_t is undefined
+        if (std::isfinite(d) && d >= -9223372036854775808.0 && d < 9223372036854775808.0) {
+            int64_t i = static_cast<int64_t>(d);
+            if (static_cast<double>(i) == d) {
+                return i;
+            }
+        }
+        return d;
+    }
+    case napi_string: {
+        size_t length;
+        napi_get_value_string_utf8(env, value, nullptr, 0, &length);
+        std::string s(length, '\0');
+        napi_get_value_string_utf8(env, value, &s[0], length + 1, &length);
+        return s;
+    }
+    case napi_object: {
+        bool isArray;
+        napi_is_array(env, value, &isArray);
+        if (isArray) {
+            uint32_t length;
+            napi_get_array_length(env, value, &length);
+            json array = json::array();
+            for (uint32_t i = 0; i < length; i++) {
+                napi_value element;
+                napi_get_element(env, value, i, &element);
+                array.push_back(toJson(env, element));
+            }
+            return array;
+        }
+
+        napi_value keys;
+        napi_get_all_property_names(env, value, napi_key_own_only,
+                                    static_cast<napi_key_filter>(napi_key_enumerable | napi_key_skip_symbols),
+                                    napi_key_numbers_to_strings, &keys);
+        uint32_t count;
+        napi_get_array_length(env, keys, &count);
+        json object = json::object();
+        for (uint32_t i = 0; i < count; i++) {
+            napi_value key, property;
+            napi_get_element(env, keys, i, &key);
+            napi_get_property(env, value, key, &property);
+            // An undefined property must read as missing in `input.value(key, default)`
+            napi_valuetype propertyType;
+            napi_typeof(env, property, &propertyType);
+            if (propertyType == napi_undefined || propertyType == napi_function || propertyType == napi_symbol) {
+                continue;
+            }
+            object[toJson(env, key).get<std::string>()] = toJson(env, property);
+        }
+        return object;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+// json -> JS value
+napi_value fromJson(napi_env env, const json& j) {
+    napi_value result = nullptr;
+
+    switch (j.type()) {
+    case json::value_t::boolean:
+        napi_get_boolean(env, j.get<bool>(), &result);
+        break;
+    case json::value_t::number_integer:
+        napi_create_int64(env, j.get<int64_t>(), &result);
+        break;
+    case json::value_t::number_unsigned:
+    case json::value_t::number_float:
+        napi_create_double(env, j.get<double>(), &result);
+        break;
+    case json::value_t::string: {
+        const std::string& s = j.get_ref<const std::string&>();
+        napi_create_string_utf8(env, s.data(), s.size(), &result);
+        break;
+    }
+    case json::value_t::array:
+        napi_create_array_with_length(env, j.size(), &result);
+        for (size_t i = 0; i < j.size(); i++) {
+            napi_set_element(env, result, static_cast<uint32_t>(i), fromJson(env, j[i]));
+        }
+        break;
+    case json::value_t::object:
+        napi_create_object(env, &result);
+        for (const auto& item : j.items()) {
+            napi_set_named_property(env, result, item.key().c_str(), fromJson(env, item.value()));
+        }
+        break;
+    default:
+        napi_get_null(env, &result);
+        break;
+    }
+
+    return result;
+}
+
+struct CommandWork {
+    std::string command;
+    json request;
+    json response;
+    napi_deferred deferred = nullptr;
+    napi_async_work work = nullptr;
+};
+
+// Runs on a threadpool thread: no N-API calls allowed here
+void executeCommand(napi_env, void* data) {
+    CommandWork* job = static_cast<CommandWork*>(data);
+    try {
+        job->response = automata::handleCommand(job->command, job->request);
+    } catch (const std::exception& e) {
+        job->response = {
+            {"success", false},
+            {"error", e.what()}
+        };
+    }
+}
+
+void completeCommand(napi_env env, napi_status, void* data) {
+    CommandWork* job = static_cast<CommandWork*>(data);
+    napi_resolve_deferred(env, job->deferred, fromJson(env, job->response));
+    napi_delete_async_work(env, job->work);
+    delete job;
+}
+
+napi_value queueCommand(napi_env env, std::string command, napi_value request) {
+    napi_valuetype type;
+    NAPI_CALL(env, napi_typeof(env, request, &type));
+    if (type != napi_object) {
+        napi_throw_type_error(env, nullptr, "Request must be an object");
+        return nullptr;
+    }
+
+    CommandWork* job = new CommandWork();
+    job->command = std::move(command);
+    job->request = toJson(env, request);
+
+    napi_value promise, name;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "automata", NAPI_AUTO_LENGTH, &name);
+    if (napi_create_async_work(env, nullptr, name, executeCommand, completeCommand, job, &job->work) != napi_ok ||
+        napi_queue_async_work(env, job->work) != napi_ok) {
+        delete job;
+        napi_throw_error(env, nullptr, "Could not queue automata command");
+        return nullptr;
+    }
+    return promise;
+}
+
+// run(command, request): any command understood by handleCommand
+napi_value Run(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+
+    napi_valuetype type = napi_undefined;
+    if (argc == 2) {
+        napi_typeof(env, args[0], &type);
+    }
+    if (type != napi_string) {
+        napi_throw_type_error(env, nullptr, "Usage: run(command, request)");
+        return nullptr;
+    }
+    return queueCommand(env, toJson(env, args[0]).get<std::string>(), args[1]);
+}
+
+// classify(request), determinize(request), ...: the command name is bound as callback data
+napi_value RunBound(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value request;
+    void* command;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, &request, nullptr, &command));
+    if (argc < 1) {
+        napi_get_undefined(env, &request);
+    }
+    return queueCommand(env, static_cast<const char*>(command), request);
+}
+
+napi_value Init(napi_env env, napi_value exports) {
+    static const std::pair<const char*, const char*> commands[] = {
+        {"classify", "classify"},
+        {"determinize", "determinize"},
+        {"minimize", "minimize"},
+        {"validate", "validate"},
+        {"runInputs", "run"},
+        {"search", "search"},
+        {"matchAll", "match-all"},
+        {"product", "product"},
+        {"equivalent", "equivalent"},
+        {"inclusion", "inclusion"},
+        {"removeEpsilon", "remove-epsilon"},
+        {"pipeline", "pipeline"},
+    };
+
+    for (const auto& command : commands) {
+        napi_value fn;
+        NAPI_CALL(env, napi_create_function(env, command.first, NAPI_AUTO_LENGTH, RunBound,
+                                            const_cast<char*>(command.second), &fn));
+        NAPI_CALL(env, napi_set_named_property(env, exports, command.first, fn));
+    }
+
+    napi_value run;
+    NAPI_CALL(env, napi_create_function(env, "run", NAPI_AUTO_LENGTH, Run, nullptr, &run));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "run", run));
+    return exports;
+}
+
+} // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
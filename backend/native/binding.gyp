@@ -0,0 +1,21 @@
+{
+  "targets": [
+    {
+      "target_name": "automata",
+      "sources": ["automata_addon.cpp"],
+      "include_dirs": ["../../cpp"],
+      "cflags_cc!": ["-fno-exceptions", "-std=gnu++14"],
+      "cflags_cc": ["-std=c++17", "-O2", "-fexceptions"],
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17"
+      },
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "ExceptionHandling": 1,
+          "AdditionalOptions": ["/std:c++17", "/utf-8"]
+        }
+      }
+    }
+  ]
+}
@@ -5,6 +5,13 @@ import {
     testInputStringHandler, 
     minimizeDFAHandler, 
     convertNFAtoDFAHandler,
+    removeEpsilonHandler,
+    pipelineHandler,
+    searchHandler,
+    matchAllHandler,
+    productHandler,
+    equivalentHandler,
+    inclusionHandler,
     // [NEW CODE] - Import new database handlers
     saveAutomatonHandler,
     getAutomataHandler,
@@ -21,6 +28,13 @@ router.post("/generate-automaton-image", generateDOTHandler);
 router.post("/test-input-string", testInputStringHandler);
 router.post("/minimize-dfa", minimizeDFAHandler);
 router.post("/convert-nfa-to-dfa", convertNFAtoDFAHandler);
+router.post("/remove-epsilon", removeEpsilonHandler);
+router.post("/pipeline", pipelineHandler);
+router.post("/search", searchHandler);
+router.post("/match-all", matchAllHandler);
+router.post("/product", productHandler);
+router.post("/equivalent", equivalentHandler);
+router.post("/inclusion", inclusionHandler);
 
 // [NEW CODE] - Database routes
 router.post("/save-automaton", saveAutomatonHandler);
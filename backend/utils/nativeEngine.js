@@ -0,0 +1,24 @@
+import { createRequire } from "module";
+
+const require = createRequire(import.meta.url);
+
+let addon;
+
+/**
+ * Loads the in-process automata addon built from ../native (`npm run build:native`).
+ * Returns null when it has not been built or AUTOMATA_NATIVE=0, in which case
+ * callers fall back to the `automata --serve` worker pool.
+ */
+export function getNativeEngine() {
+    if (addon === undefined) {
+        addon = null;
+        if (process.env.AUTOMATA_NATIVE !== "0") {
+            try {
+                addon = require("../native/build/Release/automata.node");
+            } catch {
+                // Not built for this platform; use the worker pool
+            }
+        }
+    }
+    return addon;
+}
@@ -0,0 +1,9 @@
+import { runCommand } from "./workerPool.js";
+
+export async function removeEpsilon(data) {
+    const result = await runCommand("remove-epsilon", data);
+    if (!result.success) {
+        throw new Error(`Epsilon removal failed: ${result.error}`);
+    }
+    return result;
+}
@@ -0,0 +1,164 @@
+import { spawn } from "child_process";
+import fs from "fs";
+import path from "path";
+import readline from "readline";
+import { fileURLToPath } from "url";
+import { getNativeEngine } from "./nativeEngine.js";
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+
+// Number of warm workers per C++ tool, overridable with CPP_WORKERS
+const POOL_SIZE = Math.max(1, Number(process.env.CPP_WORKERS) || 2);
+
+// Milliseconds a worker may spend on one request, overridable with CPP_TIMEOUT_MS
+const REQUEST_TIMEOUT_MS = Math.max(1, Number(process.env.CPP_TIMEOUT_MS) || 30000);
+
+/**
+ * Keeps a fixed number of C++ tool processes running in `--serve` mode.
+ * Each worker handles one request at a time: the request is written as a
+ * single JSON line and the next line on its stdout is the response. Jobs
+ * wait in a FIFO queue until a worker is idle, and workers that exit are
+ * replaced on demand. A worker that takes longer than `timeout` ms on a
+ * request is killed and replaced, and the request is rejected.
+ */
+export class CppWorkerPool {
+    constructor(executable, size = POOL_SIZE, timeout = REQUEST_TIMEOUT_MS) {
+        this.executable = executable;
+        this.size = size;
+        this.timeout = timeout;
+        this.workers = new Set();
+        this.idle = [];
+        this.queue = [];
+
+        for (let i = 0; i < size; i++) {
+            this.idle.push(this.startWorker());
+        }
+    }
+
+    run(request) {
+        return new Promise((resolve, reject) => {
+            this.queue.push({ request, resolve, reject });
+            this.dispatch();
+        });
+    }
+
+    startWorker() {
+        const proc = spawn(this.executable, ["--serve"]);
+        const worker = { proc, job: null, timer: null };
+        this.workers.add(worker);
+        const name = path.basename(this.executable);
+
+        const lines = readline.createInterface({ input: proc.stdout });
+        lines.on("line", (line) => {
+            const job = worker.job;
+            if (!job) {
+                // Only a pending job frees the worker; a killed worker may still flush output
+                console.error(`Unexpected C++ output (${name}) with no pending request:`, line);
+                return;
+            }
+            clearTimeout(worker.timer);
+            worker.job = null;
+            try {
+                job.resolve(JSON.parse(line));
+            } catch (e) {
+                job.reject(new Error("Error parsing C++ output: " + e.message + ". Output was: " + line));
+            }
+            this.idle.push(worker);
+            this.dispatch();
+        });
+
+        // Write errors surface again as "exit"/"error" below
+        proc.stdin.on("error", () => {});
+
+        proc.stderr.on("data", (err) => {
+            console.error(`C++ stderr (${name}):`, err.toString());
+        });
+
+        const retire = (reason) => {
+            if (!this.workers.delete(worker)) return false;
+            clearTimeout(worker.timer);
+            this.idle = this.idle.filter((w) => w !== worker);
+            if (worker.job) {
+                worker.job.reject(new Error(`C++ worker ${name} ${reason}`));
+                worker.job = null;
+            }
+            return true;
+        };
+
+        proc.on("exit", (code) => {
+            if (retire(`exited with code ${code}`)) this.dispatch();
+        });
+        proc.on("error", (err) => {
+            if (retire(`failed to start: ${err.message}`)) this.dispatch();
+        });
+
+        worker.expire = () => {
+            if (!retire(`timed out after ${this.timeout} ms`)) return;
+            proc.kill("SIGKILL");
+            this.idle.push(this.startWorker());
+            this.dispatch();
+        };
+
+        return worker;
+    }
+
+    dispatch() {
+        while (this.queue.length > 0) {
+            let worker = this.idle.pop();
+            if (!worker && this.workers.size < this.size) {
+                worker = this.startWorker();
+            }
+            if (!worker) return;
+
+            const job = this.queue.shift();
+            worker.job = job;
+            worker.timer = setTimeout(worker.expire, this.timeout);
+            worker.proc.stdin.write(JSON.stringify(job.request) + "\n");
+        }
+    }
+
+    close() {
+        for (const worker of this.workers) {
+            worker.proc.stdin.end();
+        }
+    }
+}
+
+const pools = new Map();
+
+/**
+ * Path of a tool built in ../../cpp; compilers only add the .exe suffix on Windows
+ */
+export function toolPath(tool) {
+    const name = process.platform === "win32" ? `${tool}.exe` : tool;
+    return path.join(__dirname, "..", "..", "cpp", name);
+}
+
+/**
+ * Returns the shared pool for a tool in ../../cpp, e.g. getWorkerPool("automata")
+ */
+export function getWorkerPool(tool) {
+    if (!pools.has(tool)) {
+        const executable = toolPath(tool);
+        if (!fs.existsSync(executable)) {
+            throw new Error(`C++ engine not found at ${executable}; build it with "npm run build:engine" in backend/`);
+        }
+        pools.set(tool, new CppWorkerPool(executable));
+    }
+    return pools.get(tool);
+}
+
+/**
+ * Runs one command ("classify", "determinize", "minimize", "validate", "run",
+ * "search", "match-all", "product", "equivalent", "inclusion", "remove-epsilon"
+ * or "pipeline") on the multi-command automata engine, in process through the
+ * native addon when it is built, else on the worker pool
+ */
+export async function runCommand(command, data) {
+    const native = getNativeEngine();
+    if (native) {
+        return native.run(command, data);
+    }
+    return getWorkerPool("automata").run({ ...data, command });
+}
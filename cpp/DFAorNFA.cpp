@@ -1,63 +1,28 @@
 #include <iostream>
 #include <string>
-#include "./libraries/json.hpp"
+#include "./core/Commands.hpp"
+#include "./core/Serve.hpp"
 
 using json = nlohmann::json;
 using namespace std;
+using namespace automata;
 
-bool isDFA(const json& transitions, const std::vector<std::string>& symbols) {
-    // First, check if there are any non-empty epsilon transitions
-    for (const auto& [state, stateTransitions] : transitions.items()) {
-        if (stateTransitions.contains("ɛ") &&
-            stateTransitions["ɛ"].is_array() &&
-            stateTransitions["ɛ"].size() > 0) {
-            return false; // Has epsilon transitions, so it's NFA
-        }
-    }
-
-    // Check for non-epsilon symbols - each state must have exactly one transition for each symbol
-    for (const auto& [state, stateTransitions] : transitions.items()) {
-        for (const auto& symbol : symbols) {
-            // Skip epsilon symbol for DFA check - empty epsilon transitions are allowed in DFA
-            if (symbol == "ɛ") continue;
+// Reports whether an automaton is a DFA or an NFA (see core/Classify.hpp)
 
-            if (!stateTransitions.contains(symbol)) {
-                return false; // Missing transition
-            }
-            if (!stateTransitions[symbol].is_array()) {
-                return false; // Invalid format
-            }
-            if (stateTransitions[symbol].size() != 1) {
-                return false; // Multiple transitions or no transitions
-            }
-        }
+int main(int argc, char* argv[]) {
+    if (isServeMode(argc, argv)) {
+        return serveLines(classifyRequest);
     }
-    return true;
-}
 
-int main() {
     try {
         json input;
         cin >> input;
 
-        if (!input.contains("transitions") || !input.contains("symbols")) {
-            throw runtime_error("JSON must contain 'transitions' and 'symbols'");
-        }
-
-        auto transitions = input["transitions"].get<json>();
-        auto symbols = input["symbols"].get<vector<string>>();
-
-        bool isDfa = isDFA(transitions, symbols);
-
-        json response = {
-            {"success", true},
-            {"type", isDfa ? "DFA" : "NFA"}
-        };
-
-        cout << response.dump(2) << endl;
+        json result = classifyRequest(input);
+        cout << result.dump(2) << endl;
         return 0;
-    }
-    catch (const exception& e) {
+
+    } catch (const exception& e) {
         json error = {
             {"success", false},
             {"error", e.what()}
@@ -65,4 +30,4 @@ int main() {
         cout << error.dump(2) << endl;
         return 1;
     }
-}
\ No newline at end of file
+}
@@ -1,28 +1,166 @@
 #include <iostream>
 #include <fstream>
-#include <unordered_set>
-#include "./libraries/json.hpp"
+#include <iterator>
+#include <memory>
+#include <thread>
+#include "./core/Commands.hpp"
+#include "./core/MappedFile.hpp"
+#include "./core/Search.hpp"
+#include "./core/Serve.hpp"
+#include "./core/Stream.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 using json = nlohmann::json;
 using namespace std;
+using namespace automata;
+
+// Runs a DFA over input.txt, or serves run requests (see core/Runner.hpp)
+//
+//   InputString --stream automaton.json [input-file] [--threads N]
+//
+// streams raw input through the DFA instead of reading it from input.txt.
+// Files are memory-mapped; stdin (no file or "-") is read in fixed-size
+// chunks. automaton.json has the usual transitions, start_state and
+// end_states (and optional tokenize). Mapped files are scanned with N
+// threads (default: all cores) in byte mode.
+int streamMain(int argc, char* argv[]) {
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--threads" && i + 1 < argc) {
+            threads = max(1, stoi(argv[++i]));
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
 
-bool testDFA(const json& transitions, const string& start_state,
-             const unordered_set<string>& end_states,
-             const string& input) {
-    string current = start_state;
+    if (args.size() < 2) {
+        cerr << "usage: InputString --stream automaton.json [input-file] [--threads N]" << endl;
+        return 2;
+    }
+
+    ifstream automatonFile(args[1]);
+    if (!automatonFile) {
+        cerr << "Cannot open " << args[1] << endl;
+        return 1;
+    }
+    json request;
+    automatonFile >> request;
+    requireStartState(request);
 
-    for (char c : input) {
-        string symbol(1, c);
-        if (transitions.contains(current) && transitions[current].contains(symbol)) {
-            current = transitions[current][symbol][0];
+    Automaton fa = compileAutomaton(request);
+    DenseDFA dfa = buildDenseDFA(fa);
+    Tokenizer tokenizer(fa.symbols.names, requestTokenMode(request, fa.symbols.names));
+    StreamRunner runner(dfa, tokenizer);
+
+    bool result;
+    if (args.size() > 2 && args[2] != "-") {
+        // Files are memory-mapped when possible
+        result = runFile(runner, args[2], threads);
+    } else {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        result = runStream(runner, stdin);
+    }
+
+    cout << (result ? "Accepted" : "Rejected") << endl;
+    return 0;
+}
+
+// Prints where the automaton's language occurs in the input
+//
+//   InputString --search automaton.json [input-file] [--leftmost-longest]
+//
+// One line per byte offset at which a match ends, or "start end" per
+// leftmost-longest match (see core/Search.hpp). Unlike --stream, the whole
+// input is kept in memory (mapped for files) for the backward start pass.
+int searchMain(int argc, char* argv[]) {
+    bool leftmostLongest = false;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--leftmost-longest") {
+            leftmostLongest = true;
         } else {
-            return false;
+            args.push_back(argv[i]);
         }
     }
-    return end_states.count(current) > 0;
+
+    if (args.size() < 2) {
+        cerr << "usage: InputString --search automaton.json [input-file] [--leftmost-longest]" << endl;
+        return 2;
+    }
+
+    ifstream automatonFile(args[1]);
+    if (!automatonFile) {
+        cerr << "Cannot open " << args[1] << endl;
+        return 1;
+    }
+    json request;
+    automatonFile >> request;
+    requireStartState(request);
+    Searcher searcher(compileAutomaton(request), leftmostLongest);
+
+    unique_ptr<MappedFile> mapped;
+    string buffer;
+    if (args.size() > 2 && args[2] != "-") {
+        mapped.reset(new MappedFile(args[2]));
+        if (!mapped->isOpen()) {
+            ifstream in(args[2], ios::binary);
+            if (!in) {
+                cerr << "Cannot open " << args[2] << endl;
+                return 1;
+            }
+            buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+            mapped.reset();
+        }
+    } else {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        buffer.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+    }
+    const char* data = mapped ? mapped->data() : buffer.data();
+    size_t size = mapped ? mapped->size() : buffer.size();
+
+    if (leftmostLongest) {
+        searcher.forEachMatch(data, size, [](const Match& match) {
+            cout << match.start << ' ' << match.end << '\n';
+        });
+    } else {
+        searcher.forEachEnd(data, size, [](size_t end) { cout << end << '\n'; });
+    }
+    cout.flush();
+    return 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (isServeMode(argc, argv)) {
+        return serveLines(runRequest);
+    }
+
+    if (argc > 1 && string(argv[1]) == "--stream") {
+        try {
+            return streamMain(argc, argv);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (argc > 1 && string(argv[1]) == "--search") {
+        try {
+            return searchMain(argc, argv);
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+
     ifstream transFile("transitions.json");
     json transitions;
     transFile >> transitions;
@@ -32,10 +170,18 @@ int main() {
     inputFile >> inputData;
 
     string start_state = inputData["start_state"];
-    unordered_set<string> end_states(inputData["end_states"].begin(), inputData["end_states"].end());
+    if (start_state.empty()) {
+        cerr << "Error: 'start_state' must name a state" << endl;
+        return 1;
+    }
+    auto end_states = inputData["end_states"].get<vector<string>>();
     string input_string = inputData["input_string"];
 
-    bool result = testDFA(transitions, start_state, end_states, input_string);
+    Automaton fa = compileAutomaton(transitions, start_state, end_states);
+    DenseDFA dfa = buildDenseDFA(fa);
+    Tokenizer tokenizer(fa.symbols.names, requestTokenMode(inputData, fa.symbols.names));
+    bool result = tokenizer.mode() == TokenMode::Byte ? testDFA(compressByteClasses(dfa), input_string)
+                                                      : testDFA(dfa, tokenizer, input_string);
 
     if (result) {
         cout << "Accepted" << endl;
@@ -44,4 +190,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
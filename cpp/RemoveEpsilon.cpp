@@ -0,0 +1,33 @@
+#include <iostream>
+#include <string>
+#include "./core/Commands.hpp"
+#include "./core/Serve.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+using namespace automata;
+
+// Rewrites an epsilon-NFA into an epsilon-free NFA (see core/EpsilonRemoval.hpp)
+
+int main(int argc, char* argv[]) {
+    if (isServeMode(argc, argv)) {
+        return serveLines(removeEpsilonRequest);
+    }
+
+    try {
+        json input;
+        cin >> input;
+
+        json result = removeEpsilonRequest(input);
+        cout << result.dump(2) << endl;
+        return result["success"].get<bool>() ? 0 : 1;
+
+    } catch (const exception& e) {
+        json error = {
+            {"success", false},
+            {"error", e.what()}
+        };
+        cout << error.dump(2) << endl;
+        return 1;
+    }
+}
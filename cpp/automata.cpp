@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+#include "./core/Commands.hpp"
+#include "./core/Serve.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+using namespace automata;
+
+// Multi-command engine: every operation of the single-purpose tools in one
+// binary sharing the compiled IR.
+//
+//   automata <command> < request.json
+//   automata <command> --serve     one request per line for that command
+//   automata --serve               one request per line, each naming its "command"
+//
+// Commands: classify, determinize, minimize, validate, run, search, match-all,
+// product, equivalent, inclusion, remove-epsilon, pipeline
+
+void printUsage() {
+    cerr << "usage: automata <classify|determinize|minimize|validate|run|search|match-all|product|equivalent|inclusion|remove-epsilon|pipeline> [--serve]\n"
+         << "       automata --serve" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    string command = argv[1];
+
+    if (command == "--serve") {
+        return serveLines([](const json& request) {
+            if (!request.contains("command")) {
+                throw runtime_error("Request must contain 'command'");
+            }
+            return handleCommand(request["command"].get<string>(), request);
+        });
+    }
+
+    if (argc > 2 && string(argv[2]) == "--serve") {
+        return serveLines([&](const json& request) { return handleCommand(command, request); });
+    }
+
+    try {
+        json input;
+        cin >> input;
+
+        json result = handleCommand(command, input);
+        cout << result.dump(2) << endl;
+        return result.value("success", true) ? 0 : 1;
+
+    } catch (const exception& e) {
+        json error = {
+            {"success", false},
+            {"error", e.what()}
+        };
+        cout << error.dump(2) << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../libraries/json.hpp"
+
+// Compiled automaton IR shared by every tool in cpp/.
+//
+// The JSON document is walked exactly once: state names and symbols are
+// interned to dense integer IDs and the transition relation is stored in CSR
+// form (offsets + targets), so the algorithms never touch json or hash a
+// string after compilation.
+
+namespace automata {
+
+using json = nlohmann::json;
+using StateId = uint32_t;
+using SymbolId = uint32_t;
+
+constexpr uint32_t NO_ID = UINT32_MAX;
+
+// Both spellings of epsilon show up in saved automata
+inline bool isEpsilon(const std::string& symbol) {
+    return symbol == "ɛ" || symbol == "ε";
+}
+
+// Maps names to dense IDs in first-seen order
+struct Interner {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> ids;
+
+    uint32_t intern(const std::string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(names.size());
+        ids.emplace(name, id);
+        names.push_back(name);
+        return id;
+    }
+
+    uint32_t find(const std::string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? NO_ID : it->second;
+    }
+
+    const std::string& name(uint32_t id) const { return names[id]; }
+    uint32_t size() const { return static_cast<uint32_t>(names.size()); }
+};
+
+struct Automaton {
+    Interner states;
+    // Symbols listed in "symbols" come first (IDs below declaredSymbols),
+    // symbols that only appear as transition keys follow. Epsilon is never
+    // interned as a symbol; it lives in its own CSR arrays below.
+    Interner symbols;
+    uint32_t declaredSymbols = 0;
+
+    StateId start = 0;
+    std::vector<uint8_t> accepting;
+    // States that have an entry in the "transitions" object
+    std::vector<uint8_t> hasRow;
+
+    // Row (state * numSymbols() + symbol) owns targets[offsets[row] .. offsets[row + 1])
+    std::vector<uint32_t> offsets;
+    std::vector<StateId> targets;
+
+    // Epsilon edges, one row per state
+    std::vector<uint32_t> epsOffsets;
+    std::vector<StateId> epsTargets;
+
+    // Single-byte symbols, indexed by input byte
+    std::array<SymbolId, 256> byteSymbol;
+
+    uint32_t numStates() const { return states.size(); }
+    uint32_t numSymbols() const { return symbols.size(); }
+    bool hasEpsilon() const { return !epsTargets.empty(); }
+
+    uint32_t row(StateId state, SymbolId symbol) const {
+        return state * numSymbols() + symbol;
+    }
+
+    const StateId* targetsBegin(StateId state, SymbolId symbol) const {
+        return targets.data() + offsets[row(state, symbol)];
+    }
+
+    const StateId* targetsEnd(StateId state, SymbolId symbol) const {
+        return targets.data() + offsets[row(state, symbol) + 1];
+    }
+
+    uint32_t targetCount(StateId state, SymbolId symbol) const {
+        uint32_t r = row(state, symbol);
+        return offsets[r + 1] - offsets[r];
+    }
+
+    const StateId* epsilonBegin(StateId state) const {
+        return epsTargets.data() + epsOffsets[state];
+    }
+
+    const StateId* epsilonEnd(StateId state) const {
+        return epsTargets.data() + epsOffsets[state + 1];
+    }
+};
+
+// Fills byteSymbol from the single-character symbols
+inline void indexByteSymbols(Automaton& a) {
+    a.byteSymbol.fill(NO_ID);
+    for (SymbolId i = 0; i < a.numSymbols(); i++) {
+        const std::string& sym = a.symbols.name(i);
+        if (sym.size() == 1) {
+            a.byteSymbol[static_cast<unsigned char>(sym[0])] = i;
+        }
+    }
+}
+
+// Builds the IR from a bare "transitions" object plus start/end states.
+// `symbols` is the declared alphabet; pass nullptr when the caller has none.
+inline Automaton compileAutomaton(const json& transitions, const std::string& startState,
+                                  const std::vector<std::string>& endStates,
+                                  const std::vector<std::string>* symbols = nullptr,
+                                  const std::vector<std::string>* stateNames = nullptr) {
+    if (!transitions.is_object()) {
+        throw std::runtime_error("'transitions' must be an object");
+    }
+
+    Automaton a;
+    // Classification has no start state; everything else requires one
+    a.start = startState.empty() ? NO_ID : a.states.intern(startState);
+    if (stateNames) {
+        for (const std::string& s : *stateNames) {
+            a.states.intern(s);
+        }
+    }
+    if (symbols) {
+        for (const std::string& sym : *symbols) {
+            if (!isEpsilon(sym)) {
+                a.symbols.intern(sym);
+            }
+        }
+    }
+    a.declaredSymbols = a.symbols.size();
+
+    // First pass: intern every name so the CSR rows can be sized up front
+    struct Edge {
+        StateId from;
+        SymbolId symbol;
+        StateId to;
+    };
+    std::vector<Edge> edges;
+    std::vector<std::pair<StateId, StateId>> epsEdges;
+    std::vector<StateId> listed;
+
+    for (const auto& [from, stateTransitions] : transitions.items()) {
+        StateId fromId = a.states.intern(from);
+        listed.push_back(fromId);
+        if (!stateTransitions.is_object()) {
+            continue;
+        }
+        for (const auto& [symbol, nextStates] : stateTransitions.items()) {
+            if (!nextStates.is_array()) {
+                continue;
+            }
+            bool epsilon = isEpsilon(symbol);
+            SymbolId symbolId = epsilon ? NO_ID : a.symbols.intern(symbol);
+            for (const auto& next : nextStates) {
+                StateId toId = a.states.intern(next.get<std::string>());
+                if (epsilon) {
+                    epsEdges.push_back({fromId, toId});
+                } else {
+                    edges.push_back({fromId, symbolId, toId});
+                }
+            }
+        }
+    }
+
+    std::vector<StateId> endIds;
+    for (const std::string& s : endStates) {
+        endIds.push_back(a.states.intern(s));
+    }
+
+    uint32_t n = a.numStates();
+    uint32_t k = a.numSymbols();
+    a.accepting.assign(n, 0);
+    for (StateId s : endIds) {
+        a.accepting[s] = 1;
+    }
+    a.hasRow.assign(n, 0);
+    for (StateId s : listed) {
+        a.hasRow[s] = 1;
+    }
+
+    // Counting sort of the edges into CSR rows, keeping input order per row
+    a.offsets.assign(static_cast<size_t>(n) * k + 1, 0);
+    for (const Edge& e : edges) {
+        a.offsets[a.row(e.from, e.symbol) + 1]++;
+    }
+    for (size_t i = 1; i < a.offsets.size(); i++) {
+        a.offsets[i] += a.offsets[i - 1];
+    }
+    a.targets.resize(edges.size());
+    std::vector<uint32_t> fill(a.offsets.begin(), a.offsets.end() - 1);
+    for (const Edge& e : edges) {
+        a.targets[fill[a.row(e.from, e.symbol)]++] = e.to;
+    }
+
+    a.epsOffsets.assign(n + 1, 0);
+    for (const auto& [from, to] : epsEdges) {
+        a.epsOffsets[from + 1]++;
+    }
+    for (uint32_t i = 1; i <= n; i++) {
+        a.epsOffsets[i] += a.epsOffsets[i - 1];
+    }
+    a.epsTargets.resize(epsEdges.size());
+    std::vector<uint32_t> epsFill(a.epsOffsets.begin(), a.epsOffsets.end() - 1);
+    for (const auto& [from, to] : epsEdges) {
+        a.epsTargets[epsFill[from]++] = to;
+    }
+
+    indexByteSymbols(a);
+
+    return a;
+}
+
+// Builds the IR from a full automaton document as sent by the backend
+// Required fields are checked by each tool, which knows its own contract.
+inline Automaton compileAutomaton(const json& doc) {
+    if (!doc.contains("transitions")) {
+        throw std::runtime_error("JSON must contain 'transitions'");
+    }
+
+    std::vector<std::string> symbols;
+    std::vector<std::string> stateNames;
+    std::vector<std::string> endStates;
+    if (doc.contains("symbols") && doc["symbols"].is_array()) {
+        symbols = doc["symbols"].get<std::vector<std::string>>();
+    }
+    if (doc.contains("states") && doc["states"].is_array()) {
+        stateNames = doc["states"].get<std::vector<std::string>>();
+    }
+
+    if (doc.contains("end_states") && doc["end_states"].is_array()) {
+        endStates = doc["end_states"].get<std::vector<std::string>>();
+    }
+    std::string startState = doc.contains("start_state") ? doc["start_state"].get<std::string>() : "";
+
+    return compileAutomaton(doc["transitions"], startState, endStates, &symbols, &stateNames);
+}
+
+// Serializes the IR back to the document format the backend and frontend use.
+// Every state gets a row with every symbol plus an empty epsilon entry, like
+// the minimizer's output.
+inline json automatonToJson(const Automaton& a) {
+    json j;
+
+    j["states"] = a.states.names;
+    j["symbols"] = a.symbols.names;
+    j["start_state"] = a.states.name(a.start);
+
+    j["end_states"] = json::array();
+    for (StateId s = 0; s < a.numStates(); s++) {
+        if (a.accepting[s]) {
+            j["end_states"].push_back(a.states.name(s));
+        }
+    }
+
+    j["transitions"] = json::object();
+    for (StateId s = 0; s < a.numStates(); s++) {
+        json row = json::object();
+        for (SymbolId c = 0; c < a.numSymbols(); c++) {
+            json targets = json::array();
+            for (const StateId* t = a.targetsBegin(s, c); t != a.targetsEnd(s, c); ++t) {
+                targets.push_back(a.states.name(*t));
+            }
+            row[a.symbols.name(c)] = targets;
+        }
+        json epsilon = json::array();
+        for (const StateId* t = a.epsilonBegin(s); t != a.epsilonEnd(s); ++t) {
+            epsilon.push_back(a.states.name(*t));
+        }
+        row["ɛ"] = epsilon;
+        j["transitions"][a.states.name(s)] = row;
+    }
+
+    return j;
+}
+
+} // namespace automata
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "DenseDFA.hpp"
+#include "Liveness.hpp"
+
+// Alphabet compression for dense DFAs.
+//
+// Columns of the transition table that every state maps identically are
+// interchangeable, so the table only needs one column per equivalence class.
+// Byte-level DFAs typically use a handful of classes out of 256 columns
+// (e.g. "digits", "letters", "everything else"), which shrinks the table
+// by an order of magnitude and keeps it cache resident.
+
+namespace automata {
+
+struct SymbolClasses {
+    // Column -> class, for columns 0 .. numSymbols (the last is the DEAD column)
+    std::vector<uint32_t> classOf;
+    // Class -> first column in it
+    std::vector<SymbolId> representative;
+
+    uint32_t size() const { return static_cast<uint32_t>(representative.size()); }
+};
+
+// Groups identical columns. Columns are hashed over all states and only
+// compared in full on a hash match, so this is O(states x columns) time with
+// O(columns) extra memory.
+inline SymbolClasses symbolClasses(const DenseDFA& dfa) {
+    const uint32_t columns = dfa.stride;
+    std::vector<uint64_t> hashes(columns, 1469598103934665603ULL);
+    for (StateId s = 0; s < dfa.numStates; s++) {
+        const StateId* row = dfa.table.data() + static_cast<size_t>(s) * dfa.stride;
+        for (uint32_t c = 0; c < columns; c++) {
+            hashes[c] = (hashes[c] ^ row[c]) * 1099511628211ULL;
+        }
+    }
+
+    auto sameColumn = [&](uint32_t a, uint32_t b) {
+        for (StateId s = 0; s < dfa.numStates; s++) {
+            if (dfa.next(s, a) != dfa.next(s, b)) return false;
+        }
+        return true;
+    };
+
+    SymbolClasses classes;
+    classes.classOf.assign(columns, 0);
+    std::unordered_map<uint64_t, std::vector<uint32_t>> byHash;
+
+    for (uint32_t c = 0; c < columns; c++) {
+        std::vector<uint32_t>& candidates = byHash[hashes[c]];
+        uint32_t found = NO_ID;
+        for (uint32_t cls : candidates) {
+            if (sameColumn(classes.representative[cls], c)) {
+                found = cls;
+                break;
+            }
+        }
+        if (found == NO_ID) {
+            found = classes.size();
+            classes.representative.push_back(c);
+            candidates.push_back(found);
+        }
+        classes.classOf[c] = found;
+    }
+
+    return classes;
+}
+
+// Byte-stepping DFA over byte classes: a 256-entry byte -> class map plus a
+// states x classes table. Only reachable through single-byte symbols, so it
+// serves the byte tokenizer mode.
+struct ByteClassDFA {
+    static constexpr StateId DEAD = DenseDFA::DEAD;
+
+    uint32_t numStates = 0;
+    uint32_t numClasses = 0;
+    StateId start = DEAD;
+    std::vector<StateId> table;
+    std::vector<uint8_t> accepting;
+    std::array<uint8_t, 256> byteClass{};
+    // Bytes that are symbols of the alphabet
+    std::array<uint8_t, 256> alphabetByte{};
+    // Verdict per state + 1, slot 0 for DEAD; see core/Liveness.hpp
+    std::vector<uint8_t> verdicts;
+
+    StateId step(StateId state, unsigned char byte) const {
+        return table[static_cast<size_t>(state) * numClasses + byteClass[byte]];
+    }
+
+    // Also valid for DEAD, which rejects
+    Verdict verdict(StateId state) const {
+        return verdictOf(verdicts, state);
+    }
+
+    // Offset of the first byte in [pos, size) that is not a symbol, or size
+    size_t findNonAlphabet(const char* data, size_t pos, size_t size) const {
+        while (pos < size && alphabetByte[static_cast<unsigned char>(data[pos])]) {
+            pos++;
+        }
+        return pos;
+    }
+};
+
+inline ByteClassDFA compressByteClasses(const DenseDFA& dfa) {
+    SymbolClasses classes = symbolClasses(dfa);
+
+    // Renumber so only classes some byte maps to get a column; multi-byte
+    // symbols are never stepped on here
+    std::vector<uint32_t> remap(classes.size(), NO_ID);
+    std::vector<SymbolId> columns;
+    ByteClassDFA result;
+    for (int b = 0; b < 256; b++) {
+        uint32_t cls = classes.classOf[dfa.byteSymbol[b]];
+        if (remap[cls] == NO_ID) {
+            remap[cls] = static_cast<uint32_t>(columns.size());
+            columns.push_back(classes.representative[cls]);
+        }
+        result.byteClass[b] = static_cast<uint8_t>(remap[cls]);
+    }
+
+    result.numStates = dfa.numStates;
+    result.numClasses = static_cast<uint32_t>(columns.size());
+    result.start = dfa.start;
+    result.accepting = dfa.accepting;
+    result.table.resize(static_cast<size_t>(dfa.numStates) * result.numClasses);
+    for (StateId s = 0; s < dfa.numStates; s++) {
+        for (uint32_t cls = 0; cls < result.numClasses; cls++) {
+            result.table[static_cast<size_t>(s) * result.numClasses + cls] = dfa.next(s, columns[cls]);
+        }
+    }
+    std::vector<uint8_t> alphabetColumns(result.numClasses, 0);
+    for (int b = 0; b < 256; b++) {
+        result.alphabetByte[b] = dfa.byteSymbol[b] != dfa.numSymbols;
+        alphabetColumns[result.byteClass[b]] |= result.alphabetByte[b];
+    }
+    result.verdicts = stateVerdicts(result.numStates, result.numClasses, result.table, result.accepting, alphabetColumns);
+    return result;
+}
+
+} // namespace automata
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Automaton.hpp"
+
+namespace automata {
+
+// A DFA has no epsilon edges and exactly one target for every declared
+// symbol in every state listed in "transitions"
+inline bool isDFA(const Automaton& fa) {
+    // First, check if there are any non-empty epsilon transitions
+    if (fa.hasEpsilon()) {
+        return false; // Has epsilon transitions, so it's NFA
+    }
+
+    // Check for declared symbols - each listed state must have exactly one transition for each symbol
+    for (StateId state = 0; state < fa.numStates(); state++) {
+        if (!fa.hasRow[state]) continue;
+
+        for (SymbolId symbol = 0; symbol < fa.declaredSymbols; symbol++) {
+            if (fa.targetCount(state, symbol) != 1) {
+                return false; // Missing, multiple or no transitions
+            }
+        }
+    }
+    return true;
+}
+
+// Weaker than isDFA: at most one target per state and symbol (missing
+// transitions allowed) over every symbol, declared or not, and no epsilon
+// edges. Such automata can run on a dense table with the same results as
+// the set-based simulation.
+inline bool isDeterministic(const Automaton& fa) {
+    if (fa.hasEpsilon() || fa.start == NO_ID) {
+        return false;
+    }
+    for (size_t row = 0; row + 1 < fa.offsets.size(); row++) {
+        if (fa.offsets[row + 1] - fa.offsets[row] > 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace automata
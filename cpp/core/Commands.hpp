@@ -0,0 +1,813 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Automaton.hpp"
+#include "ByteClasses.hpp"
+#include "Classify.hpp"
+#include "DenseDFA.hpp"
+#include "Determinize.hpp"
+#include "EpsilonRemoval.hpp"
+#include "Equivalence.hpp"
+#include "Inclusion.hpp"
+#include "Minimize.hpp"
+#include "MultiPattern.hpp"
+#include "Product.hpp"
+#include "Runner.hpp"
+#include "Search.hpp"
+#include "Tokenizer.hpp"
+#include "Trace.hpp"
+#include "Validate.hpp"
+
+// Request handlers shared by the single-purpose tools, the `automata`
+// multi-command binary and its --serve mode. Each takes the request
+// document and returns the response document; malformed requests throw.
+
+namespace automata {
+
+inline void requireFields(const json& input, std::initializer_list<const char*> fields, const std::string& message) {
+    for (const char* field : fields) {
+        if (!input.contains(field)) {
+            throw std::runtime_error(message);
+        }
+    }
+}
+
+// compileAutomaton leaves the start as NO_ID when "start_state" is missing or
+// empty, which only classification can work with
+inline void requireStartState(const json& input) {
+    if (!input.contains("start_state") || !input["start_state"].is_string() ||
+        input["start_state"].get_ref<const std::string&>().empty()) {
+        throw std::runtime_error("'start_state' must name a state");
+    }
+}
+
+// "cache_limit": bytes of lazily determinized states to keep. Read signed so
+// a negative value is rejected instead of wrapping to a huge limit.
+inline size_t requestCacheLimit(const json& input) {
+    int64_t limit = input.value("cache_limit", static_cast<int64_t>(LazyDFA::DEFAULT_CACHE_LIMIT));
+    if (limit < 1) {
+        throw std::runtime_error("'cache_limit' must be a positive number of bytes");
+    }
+    return static_cast<size_t>(limit);
+}
+
+// ---- Serialization -------------------------------------------------------
+
+// NFAtoDFA's "dfa" object: only existing transitions are listed
+inline json determinizedToJson(const NamedDFA& dfa) {
+    const DenseDFA& t = dfa.table;
+    json transitions = json::object();
+    std::vector<std::string> endStates;
+
+    for (StateId s = 0; s < t.numStates; s++) {
+        json row = json::object();
+        for (SymbolId c = 0; c < t.numSymbols; c++) {
+            StateId next = t.next(s, c);
+            if (next != DenseDFA::DEAD) {
+                row[dfa.alphabet[c]] = json::array({dfa.states[next]});
+            }
+        }
+        transitions[dfa.states[s]] = row;
+        if (t.accepting[s]) {
+            endStates.push_back(dfa.states[s]);
+        }
+    }
+
+    return json{
+        {"states", dfa.states},
+        {"symbols", dfa.alphabet},
+        {"transitions", transitions},
+        {"start_state", dfa.states[t.start]},
+        {"end_states", endStates}
+    };
+}
+
+// MinimizeDFA's output: states in name order, every symbol listed
+inline json minimizedToJson(const NamedDFA &dfa) {
+    json j;
+    j["success"] = true;
+
+    // Emit states in name order so the output does not depend on class numbering
+    std::vector<uint32_t> order(dfa.states.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return dfa.states[a] < dfa.states[b]; });
+
+    j["states"] = json::array();
+    j["end_states"] = json::array();
+    for (uint32_t s : order) {
+        j["states"].push_back(dfa.states[s]);
+        if (dfa.table.accepting[s]) {
+            j["end_states"].push_back(dfa.states[s]);
+        }
+    }
+
+    j["symbols"] = dfa.alphabet;
+
+    j["start_state"] = dfa.states[dfa.table.start];
+
+    // Format transitions as expected by frontend
+    j["transitions"] = json::object();
+    for (uint32_t s : order) {
+        const std::string &state = dfa.states[s];
+        j["transitions"][state] = json::object();
+        for (SymbolId c = 0; c < dfa.table.numSymbols; c++) {
+            StateId next = dfa.table.next(s, c);
+            if (next != DenseDFA::DEAD) {
+                j["transitions"][state][dfa.alphabet[c]] = json::array({dfa.states[next]});
+            } else {
+                j["transitions"][state][dfa.alphabet[c]] = json::array();
+            }
+        }
+        // Add empty epsilon transitions
+        j["transitions"][state]["ɛ"] = json::array();
+    }
+
+    return j;
+}
+
+inline json resultToJson(const ValidationResult& result, size_t inputLength, bool includePath) {
+    json response = {
+        {"success", true},
+        {"accepted", result.accepted},
+        {"final_state", result.currentState},
+        {"input_length", inputLength},
+        {"decided_at", result.decidedAt}
+    };
+
+    if (includePath) {
+        response["path"] = result.path;
+        response["path_length"] = result.path.size();
+    }
+
+    if (!result.error.empty()) {
+        response["error"] = result.error;
+        response["success"] = false;
+    }
+
+    return response;
+}
+
+// "tokenize": auto (default), byte, utf8 or token; see core/Tokenizer.hpp
+inline TokenMode requestTokenMode(const json& request, const std::vector<std::string>& symbols) {
+    return parseTokenMode(request.value("tokenize", std::string("auto")), symbols);
+}
+
+// An input is either a string, split by the tokenizer, or an array of
+// already separated symbols. Lengths are in bytes and symbols respectively.
+inline json validateInput(StringValidator& validator, const json& item, bool includePath) {
+    if (item.is_array()) {
+        std::vector<std::string> tokens = item.get<std::vector<std::string>>();
+        return resultToJson(validator.validateTokens(tokens, includePath), tokens.size(), includePath);
+    }
+    std::string inputString = item.get<std::string>();
+    return resultToJson(validator.validateString(inputString, includePath), inputString.length(), includePath);
+}
+
+inline json validateInput(LazyValidator& validator, const json& item, bool) {
+    if (item.is_array()) {
+        std::vector<std::string> tokens = item.get<std::vector<std::string>>();
+        return resultToJson(validator.validateTokens(tokens), tokens.size(), false);
+    }
+    const std::string& inputString = item.get_ref<const std::string&>();
+    return resultToJson(validator.validateString(inputString), inputString.length(), false);
+}
+
+// "trace": the states and symbols of an actual run, see core/Trace.hpp
+inline json traceToJson(const Automaton& fa, const RunTrace& trace) {
+    json steps = json::array();
+    for (const TraceStep& step : trace.steps) {
+        json entry = {{"state", fa.states.name(step.state)}};
+        if (step.epsilon) {
+            entry["symbol"] = "ɛ";
+        } else if (step.symbol != NO_ID) {
+            entry["symbol"] = fa.symbols.name(step.symbol);
+        }
+        steps.push_back(entry);
+    }
+    return steps;
+}
+
+inline void addTrace(json& entry, const Automaton& fa, RunTracer& tracer, const json& item) {
+    RunTrace trace = item.is_array() ? tracer.traceTokens(item.get<std::vector<std::string>>())
+                                     : tracer.traceString(item.get_ref<const std::string&>());
+    entry["trace"] = traceToJson(fa, trace);
+    entry["trace_complete"] = trace.complete;
+}
+
+// Batch mode: one result per entry of "inputs", paths only on request
+template <typename Validator>
+json validateBatch(Validator& validator, const json& inputs, bool includePath,
+                   const Automaton* fa = nullptr, RunTracer* tracer = nullptr) {
+    json results = json::array();
+    size_t acceptedCount = 0;
+
+    for (const auto& item : inputs) {
+        json entry = validateInput(validator, item, includePath);
+        if (tracer) {
+            addTrace(entry, *fa, *tracer, item);
+        }
+        if (entry["accepted"].get<bool>()) acceptedCount++;
+        entry["input"] = item;
+        results.push_back(entry);
+    }
+
+    return json{
+        {"success", true},
+        {"results", results},
+        {"total", results.size()},
+        {"accepted_count", acceptedCount}
+    };
+}
+
+inline bool allStrings(const json& inputs) {
+    return std::all_of(inputs.begin(), inputs.end(), [](const json& item) { return item.is_string(); });
+}
+
+// The byte table's verdicts only see single-byte symbols, so they agree with
+// the set simulation's only when there are no others
+inline bool singleByteAlphabet(const Automaton& fa) {
+    return std::all_of(fa.symbols.names.begin(), fa.symbols.names.end(),
+                       [](const std::string& symbol) { return symbol.size() == 1; });
+}
+
+// Batch results without paths for a deterministic automaton in byte mode,
+// produced by the interleaved runner instead of the set simulation. The
+// entries match what StringValidator reports for the same inputs, as both
+// stop where the outcome is decided.
+inline json validateBatchDFA(const Automaton& fa, const json& inputs) {
+    ByteClassDFA dfa = compressByteClasses(buildDenseDFA(fa));
+
+    std::vector<const std::string*> strings;
+    for (const auto& item : inputs) {
+        strings.push_back(&item.get_ref<const std::string&>());
+    }
+    std::vector<BatchOutcome> outcomes;
+    runBatch(dfa, strings, outcomes);
+
+    json results = json::array();
+    size_t acceptedCount = 0;
+    for (size_t i = 0; i < strings.size(); i++) {
+        const std::string& inputString = *strings[i];
+        const BatchOutcome& outcome = outcomes[i];
+
+        ValidationResult result;
+        StateId state = outcome.state;
+        size_t pos = outcome.offset;
+        result.decidedAt = static_cast<int>(pos);
+        if (state == ByteClassDFA::DEAD) {
+            // A missing transition at `pos`, or an accept sink before it
+            // followed by a byte outside the alphabet: walk again up to
+            // whichever came first for the state to report
+            state = dfa.start;
+            for (pos = 0; pos < outcome.offset && dfa.verdict(state) == Verdict::Open; pos++) {
+                state = dfa.step(state, static_cast<unsigned char>(inputString[pos]));
+            }
+            std::string symbol(1, inputString[outcome.offset]);
+            result.error = "No valid transition for symbol '" + displayToken(symbol) + "' from current states";
+            result.decidedAt++;
+        }
+
+        result.position = static_cast<int>(pos);
+        result.accepted = result.error.empty() && dfa.accepting[state];
+        if (dfa.verdict(state) == Verdict::Accept || result.accepted || pos > 0) {
+            result.currentState = fa.states.name(state);
+        }
+        if (result.accepted) acceptedCount++;
+
+        json entry = resultToJson(result, inputString.length(), false);
+        entry["input"] = inputString;
+        results.push_back(entry);
+    }
+
+    return json{
+        {"success", true},
+        {"results", results},
+        {"total", results.size()},
+        {"accepted_count", acceptedCount}
+    };
+}
+
+// Single "input" or batch "inputs" against an already compiled automaton.
+// With "trace": true every result also carries an actual run.
+inline json validateInputs(const Automaton& fa, const json& input) {
+    TokenMode mode = requestTokenMode(input, fa.symbols.names);
+    std::optional<RunTracer> tracer;
+    if (input.value("trace", false)) {
+        tracer.emplace(fa, mode);
+    }
+    RunTracer* tracing = tracer ? &*tracer : nullptr;
+
+    if (input.contains("inputs")) {
+        bool includePath = input.value("include_path", false);
+        if (!includePath && !tracing && mode == TokenMode::Byte && allStrings(input["inputs"]) && singleByteAlphabet(fa) &&
+            isDeterministic(fa)) {
+            return validateBatchDFA(fa, input["inputs"]);
+        }
+        if (!includePath) {
+            LazyValidator validator(fa, mode, requestCacheLimit(input));
+            return validateBatch(validator, input["inputs"], false, &fa, tracing);
+        }
+        StringValidator validator(fa, mode);
+        return validateBatch(validator, input["inputs"], includePath, &fa, tracing);
+    }
+
+    if (tracing) {
+        StringValidator validator(fa, mode);
+        json response = validateInput(validator, input["input"], true);
+        addTrace(response, fa, *tracing, input["input"]);
+        return response;
+    }
+
+    StringValidator validator(fa, mode);
+
+    return validateInput(validator, input["input"], true);
+}
+
+// `byteClasses` is the compressed table used for string inputs in byte mode,
+// `verdicts` those of the dense table for the other inputs
+inline RunResult runInput(const DenseDFA& dfa, const std::vector<uint8_t>& verdicts, const ByteClassDFA* byteClasses,
+                          const Tokenizer& tokenizer, const json& item) {
+    if (byteClasses && item.is_string()) {
+        return runDFA(*byteClasses, item.get_ref<const std::string&>());
+    }
+    if (item.is_array()) {
+        std::vector<SymbolId> symbols;
+        for (const auto& token : item) {
+            symbols.push_back(tokenizer.find(token.get<std::string>()));
+        }
+        return runDFA(dfa, verdicts, symbols);
+    }
+    return runDFA(dfa, verdicts, tokenizer, item.get_ref<const std::string&>());
+}
+
+// Single "input_string" or batch "inputs" on the dense DFA table, whose
+// columns are named by `alphabet`
+inline json runInputs(const DenseDFA& dfa, const std::vector<std::string>& alphabet, const json& request) {
+    Tokenizer tokenizer(alphabet, requestTokenMode(request, alphabet));
+    std::optional<ByteClassDFA> byteClasses;
+    if (tokenizer.mode() == TokenMode::Byte) {
+        byteClasses = compressByteClasses(dfa);
+    }
+    const ByteClassDFA* compressed = byteClasses ? &*byteClasses : nullptr;
+    std::vector<uint8_t> verdicts = stateVerdicts(dfa);
+
+    if (request.contains("inputs")) {
+        const json& inputs = request["inputs"];
+        json results = json::array();
+        size_t acceptedCount = 0;
+
+        if (compressed && allStrings(inputs)) {
+            // Plain byte strings go through the interleaved batch runner
+            std::vector<const std::string*> strings;
+            for (const auto& item : inputs) {
+                strings.push_back(&item.get_ref<const std::string&>());
+            }
+            std::vector<BatchOutcome> outcomes;
+            runBatch(*compressed, strings, outcomes);
+            for (const BatchOutcome& outcome : outcomes) {
+                bool accepted = outcome.state != ByteClassDFA::DEAD && compressed->accepting[outcome.state];
+                if (accepted) acceptedCount++;
+                results.push_back(accepted);
+            }
+        } else {
+            for (const auto& item : inputs) {
+                bool accepted = runInput(dfa, verdicts, compressed, tokenizer, item).accepted;
+                if (accepted) acceptedCount++;
+                results.push_back(accepted);
+            }
+        }
+        return json{
+            {"success", true},
+            {"results", results},
+            {"total", results.size()},
+            {"accepted_count", acceptedCount}
+        };
+    }
+
+    RunResult result = runInput(dfa, verdicts, compressed, tokenizer, request["input_string"]);
+    return json{
+        {"success", true},
+        {"accepted", result.accepted},
+        {"result", result.accepted ? "Accepted" : "Rejected"},
+        {"decided_at", result.decidedAt}
+    };
+}
+
+// ---- Commands ------------------------------------------------------------
+
+inline json classifyRequest(const json& input) {
+    requireFields(input, {"transitions", "symbols"}, "JSON must contain 'transitions' and 'symbols'");
+
+    Automaton fa = compileAutomaton(input);
+
+    return json{
+        {"success", true},
+        {"type", isDFA(fa) ? "DFA" : "NFA"}
+    };
+}
+
+// Main NFA to DFA conversion using subset construction
+inline json determinizeRequest(const json& input) {
+    requireFields(input, {"transitions", "start_state", "end_states", "symbols"},
+                  "Missing required fields: transitions, start_state, end_states, symbols");
+    requireStartState(input);
+
+    try {
+        Automaton nfa = compileAutomaton(input);
+        NamedDFA dfa = determinize(nfa);
+
+        return json{
+            {"success", true},
+            {"dfa", determinizedToJson(dfa)},
+            {"conversion_info", {
+                {"original_nfa_states", nfa.numStates()},
+                {"resulting_dfa_states", dfa.table.numStates},
+                {"epsilon_transitions_removed", nfa.hasEpsilon()}
+            }}
+        };
+
+    } catch (const std::exception& e) {
+        return json{
+            {"success", false},
+            {"error", std::string("Conversion error: ") + e.what()}
+        };
+    }
+}
+
+inline json minimizeRequest(const json& input) {
+    requireFields(input, {"transitions", "start_state", "end_states", "symbols"},
+                  "JSON must contain 'transitions', 'start_state', 'end_states', and 'symbols'");
+    requireStartState(input);
+
+    // Missing transitions are fine (the DFA is partial), several targets or
+    // epsilon edges are not: the dense table would keep only one of them
+    Automaton fa = compileAutomaton(input);
+    if (!isDeterministic(fa)) {
+        throw std::runtime_error("Minimization needs a DFA: the automaton has epsilon or multiple transitions; determinize it first");
+    }
+    return minimizedToJson(minimizeDFA(namedDFA(fa)));
+}
+
+inline json validateRequest(const json& input) {
+    // Validate required fields
+    if (!input.contains("transitions") || !input.contains("start_state") ||
+        !input.contains("end_states") || !(input.contains("input") || input.contains("inputs"))) {
+        throw std::runtime_error("Missing required fields: transitions, start_state, end_states, input");
+    }
+    requireStartState(input);
+
+    return validateInputs(compileAutomaton(input), input);
+}
+
+// Request: {transitions, start_state, end_states, input_string | inputs}
+inline json runRequest(const json& request) {
+    if (!request.contains("transitions") || !request.contains("start_state") ||
+        !request.contains("end_states") || !(request.contains("input_string") || request.contains("inputs"))) {
+        throw std::runtime_error("Missing required fields: transitions, start_state, end_states, input_string");
+    }
+    requireStartState(request);
+
+    Automaton fa = compileAutomaton(request);
+    return runInputs(buildDenseDFA(fa), fa.symbols.names, request);
+}
+
+// Request: {transitions, start_state, end_states, text, leftmost_longest?,
+// max_matches?}. Offsets are in bytes; match ends are exclusive. Only the
+// first max_matches ends (and matches) are listed, the counts cover all.
+inline json searchRequest(const json& request) {
+    requireFields(request, {"transitions", "start_state", "end_states", "text"},
+                  "Missing required fields: transitions, start_state, end_states, text");
+    requireStartState(request);
+
+    Automaton fa = compileAutomaton(request);
+    bool leftmostLongest = request.value("leftmost_longest", false);
+    size_t limit = request.value("max_matches", std::numeric_limits<size_t>::max());
+    const std::string& text = request["text"].get_ref<const std::string&>();
+
+    Searcher searcher(fa, leftmostLongest);
+    json ends = json::array();
+    size_t endCount = 0;
+    searcher.forEachEnd(text.data(), text.size(), [&](size_t end) {
+        if (endCount++ < limit) ends.push_back(end);
+    });
+
+    json response = {
+        {"success", true},
+        {"match_ends", ends},
+        {"end_count", endCount}
+    };
+
+    if (leftmostLongest) {
+        json matches = json::array();
+        size_t matchCount = 0;
+        searcher.forEachMatch(text.data(), text.size(), [&](const Match& match) {
+            if (matchCount++ < limit) matches.push_back({{"start", match.start}, {"end", match.end}});
+        });
+        response["matches"] = matches;
+        response["match_count"] = matchCount;
+    }
+    return response;
+}
+
+// Request: {patterns: [automaton with optional "id"], input | inputs,
+// tokenize?}. Every result lists the ids (else indices) of the patterns
+// that accept the input, from one pass of the joint DFA.
+inline json matchAllRequest(const json& request) {
+    if (!request.contains("patterns") || !request["patterns"].is_array() ||
+        !(request.contains("input") || request.contains("inputs"))) {
+        throw std::runtime_error("Missing required fields: patterns, input");
+    }
+
+    const json& patternDocs = request["patterns"];
+    std::vector<Automaton> patterns;
+    json ids = json::array();
+    for (size_t i = 0; i < patternDocs.size(); i++) {
+        requireFields(patternDocs[i], {"transitions", "start_state", "end_states"},
+                      "Every pattern needs transitions, start_state and end_states");
+        requireStartState(patternDocs[i]);
+        patterns.push_back(compileAutomaton(patternDocs[i]));
+        ids.push_back(patternDocs[i].contains("id") ? patternDocs[i]["id"] : json(i));
+    }
+
+    MultiDFA multi = buildMultiDFA(patterns);
+    TokenMode mode = requestTokenMode(request, multi.dfa.alphabet);
+    MultiMatcher matcher(multi, mode);
+
+    auto idsOf = [&](const std::vector<uint32_t>& matched) {
+        json list = json::array();
+        for (uint32_t p : matched) {
+            list.push_back(ids[p]);
+        }
+        return list;
+    };
+    auto matchItem = [&](const json& item) -> const std::vector<uint32_t>& {
+        if (item.is_array()) {
+            return matcher.matchTokens(item.get<std::vector<std::string>>());
+        }
+        return matcher.matchString(item.get_ref<const std::string&>());
+    };
+
+    json response = {
+        {"success", true},
+        {"dfa_states", multi.dfa.table.numStates}
+    };
+
+    if (request.contains("inputs")) {
+        const json& inputs = request["inputs"];
+        json results = json::array();
+        size_t matchedCount = 0;
+
+        if (mode == TokenMode::Byte && allStrings(inputs)) {
+            std::vector<const std::string*> strings;
+            for (const auto& item : inputs) {
+                strings.push_back(&item.get_ref<const std::string&>());
+            }
+            std::vector<uint32_t> labels;
+            matcher.matchBatch(strings, labels);
+            for (uint32_t label : labels) {
+                if (label != 0) matchedCount++;
+                results.push_back(idsOf(matcher.labelSet(label)));
+            }
+        } else {
+            for (const auto& item : inputs) {
+                const std::vector<uint32_t>& matched = matchItem(item);
+                if (!matched.empty()) matchedCount++;
+                results.push_back(idsOf(matched));
+            }
+        }
+        response["results"] = results;
+        response["total"] = results.size();
+        response["matched_count"] = matchedCount;
+        return response;
+    }
+
+    response["matches"] = idsOf(matchItem(request["input"]));
+    return response;
+}
+
+// Two-automaton requests carry complete "left" and "right" automata
+inline void requirePair(const json& request) {
+    requireFields(request, {"left", "right"}, "Missing required fields: left, right");
+    for (const char* side : {"left", "right"}) {
+        requireFields(request[side], {"transitions", "start_state", "end_states"},
+                      std::string("'") + side + "' needs transitions, start_state and end_states");
+        requireStartState(request[side]);
+    }
+}
+
+// Request: {left, right, operation, minimize?}. Both automata are taken as
+// DFAs over their own alphabets (NFAs are determinized first) and combined
+// by intersection, union, difference (left minus right) or xor. "witness"
+// is a shortest accepted word, absent when the result is empty.
+inline json productRequest(const json& request) {
+    requireFields(request, {"operation"}, "Missing required fields: left, right, operation");
+    requirePair(request);
+
+    ProductOp op = parseProductOp(request["operation"].get<std::string>());
+    NamedDFA product = productDFA(toDFA(compileAutomaton(request["left"])),
+                                  toDFA(compileAutomaton(request["right"])), op);
+    size_t productStates = product.table.numStates;
+    if (request.value("minimize", true)) {
+        product = minimizeDFA(product);
+    }
+
+    std::optional<std::vector<std::string>> witness = shortestAccepted(product);
+    json response = {
+        {"success", true},
+        {"operation", request["operation"]},
+        {"product_states", productStates},
+        {"states", product.table.numStates},
+        {"empty", !witness}
+    };
+    if (witness) {
+        response["witness"] = *witness;
+    }
+    response["automaton"] = minimizedToJson(product);
+    response["automaton"].erase("success");
+    return response;
+}
+
+// Request: {left, right}. Two deterministic automata are compared with the
+// union-find check, which finds a shortest "counterexample" (an array of
+// symbols); otherwise inclusion is checked both ways with antichains.
+inline json equivalentRequest(const json& request) {
+    requirePair(request);
+
+    Automaton left = compileAutomaton(request["left"]);
+    Automaton right = compileAutomaton(request["right"]);
+    bool deterministic = isDeterministic(left) && isDeterministic(right);
+    EquivalenceResult result = deterministic ? dfaEquivalence(toDFA(left), toDFA(right))
+                                             : nfaEquivalence(left, right);
+    json response = {
+        {"success", true},
+        {"equivalent", result.equivalent},
+        {"method", deterministic ? "union-find" : "antichain"},
+        {"pairs_checked", result.pairsChecked}
+    };
+    if (!result.equivalent) {
+        response["counterexample"] = result.counterexample;
+        response["accepted_by"] = result.acceptedByLeft ? "left" : "right";
+    }
+    return response;
+}
+
+// Request: {left, right}. Whether every word left accepts is accepted by
+// right; if not, "counterexample" is such a word.
+inline json inclusionRequest(const json& request) {
+    requirePair(request);
+
+    InclusionResult result = nfaInclusion(compileAutomaton(request["left"]), compileAutomaton(request["right"]));
+    json response = {
+        {"success", true},
+        {"included", result.included},
+        {"pairs_checked", result.pairsChecked}
+    };
+    if (!result.included) {
+        response["counterexample"] = result.counterexample;
+    }
+    return response;
+}
+
+// Rewrites an epsilon-NFA into an epsilon-free NFA accepting the same language
+inline json removeEpsilonRequest(const json& input) {
+    requireFields(input, {"transitions", "start_state", "end_states", "symbols"},
+                  "Missing required fields: transitions, start_state, end_states, symbols");
+    requireStartState(input);
+
+    try {
+        Automaton nfa = compileAutomaton(input);
+
+        EpsilonRemovalStats stats;
+        Automaton result = removeEpsilon(nfa, &stats);
+
+        return json{
+            {"success", true},
+            {"nfa", automatonToJson(result)},
+            {"removal_info", {
+                {"epsilon_transitions_removed", stats.epsilonTransitionsRemoved},
+                {"transitions_added", stats.transitionsAdded},
+                {"original_transitions", stats.transitionsBefore},
+                {"resulting_transitions", stats.transitionsAfter},
+                {"accepting_states_added", stats.acceptingStatesAdded}
+            }}
+        };
+
+    } catch (const std::exception& e) {
+        return json{
+            {"success", false},
+            {"error", std::string("Epsilon removal error: ") + e.what()}
+        };
+    }
+}
+
+// Chains steps on the in-memory IR, e.g.
+//   {"steps": ["determinize", "minimize", "validate"], "inputs": [...], ...automaton}
+// The automaton is held either as the CSR IR (possibly nondeterministic) or
+// as a dense DFA, and only converted between the two when a step needs it.
+inline json pipelineRequest(const json& input) {
+    requireFields(input, {"transitions", "start_state", "end_states", "steps"},
+                  "Missing required fields: transitions, start_state, end_states, steps");
+    requireStartState(input);
+
+    std::optional<Automaton> nfa = compileAutomaton(input);
+    std::optional<NamedDFA> dfa;
+    json steps = json::array();
+    json response = {{"success", true}};
+
+    auto requireDFA = [&](const std::string& step) -> const NamedDFA& {
+        if (!dfa) {
+            if (!isDFA(*nfa)) {
+                throw std::runtime_error("'" + step + "' needs a DFA; add a 'determinize' step first");
+            }
+            dfa = namedDFA(*nfa);
+            nfa.reset();
+        }
+        return *dfa;
+    };
+
+    auto requireAutomaton = [&]() -> const Automaton& {
+        if (!nfa) {
+            nfa = toAutomaton(*dfa);
+        }
+        return *nfa;
+    };
+
+    for (const auto& stepValue : input["steps"]) {
+        std::string step = stepValue.get<std::string>();
+        json info = {{"step", step}};
+
+        if (step == "classify") {
+            info["type"] = (dfa || isDFA(*nfa)) ? "DFA" : "NFA";
+        } else if (step == "remove_epsilon") {
+            // A DFA has no epsilon edges; the step is reported as skipped
+            if (dfa) {
+                info["skipped"] = "already a DFA";
+            } else {
+                EpsilonRemovalStats stats;
+                nfa = removeEpsilon(*nfa, &stats);
+                info["epsilon_transitions_removed"] = stats.epsilonTransitionsRemoved;
+                info["transitions_added"] = stats.transitionsAdded;
+            }
+        } else if (step == "determinize") {
+            if (dfa) {
+                info["skipped"] = "already a DFA";
+            } else {
+                info["original_nfa_states"] = nfa->numStates();
+                dfa = determinize(*nfa);
+                nfa.reset();
+            }
+            info["states"] = dfa->table.numStates;
+        } else if (step == "minimize") {
+            const NamedDFA& current = requireDFA(step);
+            info["original_states"] = current.table.numStates;
+            dfa = minimizeDFA(current);
+            info["states"] = dfa->table.numStates;
+        } else if (step == "validate") {
+            response["validation"] = validateInputs(requireAutomaton(), input);
+        } else if (step == "run") {
+            const NamedDFA& current = requireDFA(step);
+            response["run"] = runInputs(current.table, current.alphabet, input);
+        } else {
+            throw std::runtime_error("Unknown pipeline step '" + step + "'");
+        }
+
+        // A DFA and its CSR copy are only kept together right after validate
+        if (dfa && nfa && step != "validate") {
+            nfa.reset();
+        }
+        steps.push_back(info);
+    }
+
+    response["steps"] = steps;
+    response["automaton"] = dfa ? minimizedToJson(*dfa) : automatonToJson(*nfa);
+    response["automaton"].erase("success");
+    return response;
+}
+
+// Dispatch used by `automata <command>` and by requests carrying "command"
+inline json handleCommand(const std::string& command, const json& input) {
+    if (command == "classify") return classifyRequest(input);
+    if (command == "determinize") return determinizeRequest(input);
+    if (command == "minimize") return minimizeRequest(input);
+    if (command == "validate") return validateRequest(input);
+    if (command == "run") return runRequest(input);
+    if (command == "search") return searchRequest(input);
+    if (command == "match-all") return matchAllRequest(input);
+    if (command == "product") return productRequest(input);
+    if (command == "equivalent") return equivalentRequest(input);
+    if (command == "inclusion") return inclusionRequest(input);
+    if (command == "remove-epsilon") return removeEpsilonRequest(input);
+    if (command == "pipeline") return pipelineRequest(input);
+    throw std::runtime_error("Unknown command '" + command + "'");
+}
+
+} // namespace automata
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Automaton.hpp"
+
+// Flat transition table for deterministic automata.
+//
+// All transitions live in one contiguous states x stride array. Missing
+// transitions hold the DEAD sentinel, and every row carries one extra
+// all-DEAD column that input bytes outside the alphabet are mapped to, so
+// stepping on a byte is a single table load with no branches on the symbol.
+
+namespace automata {
+
+struct DenseDFA {
+    static constexpr StateId DEAD = NO_ID;
+
+    uint32_t numStates = 0;
+    uint32_t numSymbols = 0;
+    uint32_t stride = 1; // numSymbols + the all-DEAD column
+    StateId start = DEAD;
+    std::vector<StateId> table;
+    std::vector<uint8_t> accepting;
+    // Input byte -> column; bytes that are not symbols map to the DEAD column
+    std::array<SymbolId, 256> byteSymbol;
+
+    DenseDFA() { byteSymbol.fill(0); }
+
+    DenseDFA(uint32_t states, uint32_t symbols)
+        : numStates(states), numSymbols(symbols), stride(symbols + 1),
+          table(static_cast<size_t>(states) * (symbols + 1), DEAD), accepting(states, 0) {
+        byteSymbol.fill(symbols);
+    }
+
+    StateId next(StateId state, SymbolId symbol) const {
+        return table[static_cast<size_t>(state) * stride + symbol];
+    }
+
+    void set(StateId state, SymbolId symbol, StateId target) {
+        table[static_cast<size_t>(state) * stride + symbol] = target;
+    }
+
+    StateId step(StateId state, unsigned char byte) const {
+        return table[static_cast<size_t>(state) * stride + byteSymbol[byte]];
+    }
+
+    // Appends a non-accepting state whose transitions are all DEAD
+    StateId addState() {
+        table.resize(table.size() + stride, DEAD);
+        accepting.push_back(0);
+        return numStates++;
+    }
+};
+
+// Dense DFA plus the names needed to serialize it or hand it to another stage
+struct NamedDFA {
+    std::vector<std::string> states;
+    std::vector<std::string> alphabet;
+    DenseDFA table;
+};
+
+// Maps single-character alphabet symbols to their columns
+inline void indexByteSymbols(NamedDFA& dfa) {
+    dfa.table.byteSymbol.fill(dfa.table.numSymbols);
+    for (SymbolId c = 0; c < dfa.alphabet.size(); c++) {
+        if (dfa.alphabet[c].size() == 1) {
+            dfa.table.byteSymbol[static_cast<unsigned char>(dfa.alphabet[c][0])] = c;
+        }
+    }
+}
+
+// Lays out the first `alphabetSize` symbols of a compiled automaton as a
+// dense table. Rows with several targets keep the first one; callers that
+// need a real DFA check determinism before building.
+inline DenseDFA buildDenseDFA(const Automaton& fa, uint32_t alphabetSize) {
+    DenseDFA dfa(fa.numStates(), alphabetSize);
+    dfa.start = fa.start;
+
+    for (StateId s = 0; s < fa.numStates(); s++) {
+        dfa.accepting[s] = fa.accepting[s];
+        for (SymbolId c = 0; c < alphabetSize; c++) {
+            if (fa.targetCount(s, c) > 0) {
+                dfa.set(s, c, *fa.targetsBegin(s, c));
+            }
+        }
+    }
+
+    for (int b = 0; b < 256; b++) {
+        SymbolId symbol = fa.byteSymbol[b];
+        if (symbol != NO_ID && symbol < alphabetSize) {
+            dfa.byteSymbol[b] = symbol;
+        }
+    }
+
+    return dfa;
+}
+
+inline DenseDFA buildDenseDFA(const Automaton& fa) {
+    return buildDenseDFA(fa, fa.numSymbols());
+}
+
+// Dense view of a compiled automaton over its declared alphabet
+inline NamedDFA namedDFA(const Automaton& fa) {
+    NamedDFA dfa;
+    dfa.states = fa.states.names;
+    dfa.alphabet.assign(fa.symbols.names.begin(), fa.symbols.names.begin() + fa.declaredSymbols);
+    dfa.table = buildDenseDFA(fa, fa.declaredSymbols);
+    return dfa;
+}
+
+// Converts a dense DFA back to the CSR IR, e.g. for the NFA simulator
+inline Automaton toAutomaton(const NamedDFA& dfa) {
+    const DenseDFA& t = dfa.table;
+    Automaton a;
+    for (const std::string& name : dfa.states) {
+        a.states.intern(name);
+    }
+    for (const std::string& symbol : dfa.alphabet) {
+        a.symbols.intern(symbol);
+    }
+    a.declaredSymbols = a.numSymbols();
+    a.start = t.start;
+    a.accepting = t.accepting;
+    a.hasRow.assign(t.numStates, 1);
+
+    a.offsets.assign(static_cast<size_t>(t.numStates) * t.numSymbols + 1, 0);
+    for (StateId s = 0; s < t.numStates; s++) {
+        for (SymbolId c = 0; c < t.numSymbols; c++) {
+            a.offsets[a.row(s, c)] = static_cast<uint32_t>(a.targets.size());
+            StateId next = t.next(s, c);
+            if (next != DenseDFA::DEAD) {
+                a.targets.push_back(next);
+            }
+        }
+    }
+    a.offsets.back() = static_cast<uint32_t>(a.targets.size());
+    a.epsOffsets.assign(t.numStates + 1, 0);
+    indexByteSymbols(a);
+    return a;
+}
+
+} // namespace automata
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "DenseDFA.hpp"
+#include "EpsilonClosure.hpp"
+#include "StateSet.hpp"
+
+// Subset construction from the compiled IR to a dense DFA.
+
+namespace automata {
+
+// Function to get the set of states reachable from a set of states on a given symbol
+inline void move(const StateSet& states, SymbolId symbol, const Automaton& nfa, StateSet& result) {
+    result.clear();
+    states.forEach([&](StateId state) {
+        for (const StateId* next = nfa.targetsBegin(state, symbol); next != nfa.targetsEnd(state, symbol); ++next) {
+            result.insert(*next);
+        }
+    });
+}
+
+// DFA states are named q0, q1, ... in discovery order. The empty subset is
+// never materialized; it is the DEAD sentinel of the dense table.
+//
+// With `unanchored`, the start closure is added back after every step, as if
+// the start state had a self-loop on every symbol: the DFA then accepts
+// every input with a suffix in the language, which is what a search needs.
+//
+// `subsetsOut`, if given, receives the NFA states making up each DFA state.
+inline NamedDFA determinize(const Automaton& nfa, bool unanchored = false,
+                            std::vector<StateSet>* subsetsOut = nullptr) {
+    NamedDFA dfa;
+    // Epsilon is never interned as a symbol, so the declared symbols are the DFA alphabet
+    dfa.alphabet.assign(nfa.symbols.names.begin(), nfa.symbols.names.begin() + nfa.declaredSymbols);
+    dfa.table = DenseDFA(0, nfa.declaredSymbols);
+    indexByteSymbols(dfa);
+
+    // Closure of every NFA state is computed once up front
+    EpsilonClosure closure(nfa);
+    StateSet accepting = acceptingSet(nfa);
+
+    std::vector<StateSet> subsets;
+    std::unordered_map<StateSet, StateId, StateSetHash> subsetIndex;
+
+    auto addState = [&](const StateSet& nfaStates) {
+        auto it = subsetIndex.find(nfaStates);
+        if (it != subsetIndex.end()) {
+            return it->second;
+        }
+
+        StateId id = dfa.table.addState();
+        dfa.table.accepting[id] = nfaStates.intersects(accepting);
+        dfa.states.push_back("q" + std::to_string(id));
+        subsets.push_back(nfaStates);
+        subsetIndex.emplace(nfaStates, id);
+        return id;
+    };
+
+    // Start with epsilon closure of NFA start state
+    StateSet startSet(nfa.numStates());
+    closure.closeState(nfa.start, startSet);
+    dfa.table.start = addState(startSet);
+
+    // States are processed in discovery order, so the id doubles as the queue
+    StateSet moveResult(nfa.numStates());
+    StateSet newStateSet(nfa.numStates());
+    for (StateId current = 0; current < dfa.table.numStates; current++) {
+        for (SymbolId symbol = 0; symbol < nfa.declaredSymbols; symbol++) {
+            // Compute epsilon closure of move(currentStateSet, symbol)
+            move(subsets[current], symbol, nfa, moveResult);
+            closure.close(moveResult, newStateSet);
+            if (unanchored) {
+                newStateSet |= startSet;
+            }
+
+            if (!newStateSet.empty()) {
+                StateId target = addState(newStateSet);
+                dfa.table.set(current, symbol, target);
+            }
+        }
+    }
+
+    if (subsetsOut) {
+        *subsetsOut = std::move(subsets);
+    }
+    return dfa;
+}
+
+} // namespace automata
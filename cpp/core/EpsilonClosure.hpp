@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Automaton.hpp"
+#include "StateSet.hpp"
+
+// Precomputed epsilon-closure of every state.
+//
+// The epsilon graph is condensed into strongly connected components with an
+// iterative Tarjan pass. Tarjan emits components in reverse topological
+// order, so each component's closure is its own members plus the already
+// finished closures of its successors. Closing a set afterwards is a union
+// of precomputed rows instead of a graph search.
+
+namespace automata {
+
+class EpsilonClosure {
+public:
+    EpsilonClosure() = default;
+
+    explicit EpsilonClosure(const Automaton& fa) : numStates_(fa.numStates()) {
+        if (!fa.hasEpsilon()) {
+            return;
+        }
+
+        const uint32_t n = fa.numStates();
+        component_.assign(n, NO_ID);
+
+        // Iterative Tarjan over the epsilon edges
+        std::vector<uint32_t> index(n, NO_ID);
+        std::vector<uint32_t> lowlink(n, 0);
+        std::vector<uint8_t> onStack(n, 0);
+        std::vector<StateId> sccStack;
+        std::vector<std::pair<StateId, uint32_t>> callStack; // state, next edge offset
+        uint32_t nextIndex = 0;
+
+        for (StateId root = 0; root < n; root++) {
+            if (index[root] != NO_ID) continue;
+
+            callStack.push_back({root, fa.epsOffsets[root]});
+            index[root] = lowlink[root] = nextIndex++;
+            sccStack.push_back(root);
+            onStack[root] = 1;
+
+            while (!callStack.empty()) {
+                auto& [v, edge] = callStack.back();
+
+                if (edge < fa.epsOffsets[v + 1]) {
+                    StateId w = fa.epsTargets[edge++];
+                    if (index[w] == NO_ID) {
+                        index[w] = lowlink[w] = nextIndex++;
+                        sccStack.push_back(w);
+                        onStack[w] = 1;
+                        callStack.push_back({w, fa.epsOffsets[w]});
+                    } else if (onStack[w]) {
+                        lowlink[v] = std::min(lowlink[v], index[w]);
+                    }
+                    continue;
+                }
+
+                // All edges of v explored: pop a finished component rooted at v
+                StateId finished = v;
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    StateId parent = callStack.back().first;
+                    lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+                }
+                if (lowlink[finished] == index[finished]) {
+                    emitComponent(fa, finished, sccStack, onStack);
+                }
+            }
+        }
+    }
+
+    bool trivial() const { return closures_.empty(); }
+
+    // Closure of a single state
+    void closeState(StateId state, StateSet& out) const {
+        if (trivial() || !closures_[component_[state]].size()) {
+            out.insert(state);
+        } else {
+            out |= closures_[component_[state]];
+        }
+    }
+
+    // out = closure(in); `out` must not alias `in`
+    void close(const StateSet& in, StateSet& out) const {
+        if (trivial()) {
+            out = in;
+            return;
+        }
+        out.clear();
+        in.forEach([&](StateId state) { closeState(state, out); });
+    }
+
+    // Closes `set` in place using `scratch` as temporary storage
+    void closeInPlace(StateSet& set, StateSet& scratch) const {
+        if (trivial()) return;
+        close(set, scratch);
+        std::swap(set, scratch);
+    }
+
+private:
+    void emitComponent(const Automaton& fa, StateId root, std::vector<StateId>& sccStack,
+                       std::vector<uint8_t>& onStack) {
+        uint32_t id = static_cast<uint32_t>(closures_.size());
+        std::vector<StateId> members;
+        StateId w;
+        do {
+            w = sccStack.back();
+            sccStack.pop_back();
+            onStack[w] = 0;
+            component_[w] = id;
+            members.push_back(w);
+        } while (w != root);
+
+        // Successor components were emitted earlier, so their rows are final
+        StateSet closure(numStates_);
+        bool hasEdges = false;
+        for (StateId m : members) {
+            closure.insert(m);
+            for (const StateId* t = fa.epsilonBegin(m); t != fa.epsilonEnd(m); ++t) {
+                hasEdges = true;
+                uint32_t target = component_[*t];
+                if (target != id) {
+                    closeState(*t, closure);
+                }
+            }
+        }
+
+        // Singleton components without epsilon edges keep an empty row and
+        // close to themselves, which saves a full bitset per plain state
+        closures_.push_back(hasEdges ? std::move(closure) : StateSet());
+    }
+
+    uint32_t numStates_ = 0;
+    std::vector<uint32_t> component_;
+    std::vector<StateSet> closures_;
+};
+
+} // namespace automata
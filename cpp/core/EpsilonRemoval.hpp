@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Automaton.hpp"
+#include "EpsilonClosure.hpp"
+
+// Rewrites an epsilon-NFA into an equivalent epsilon-free NFA.
+//
+// State p gets every symbol transition of every state in closure(p), and
+// becomes accepting when its closure contains an accepting state. The
+// closures come from the precomputed SCC table, so the pass costs the
+// condensation plus the size of the output automaton.
+
+namespace automata {
+
+struct EpsilonRemovalStats {
+    uint32_t epsilonTransitionsRemoved = 0;
+    uint32_t transitionsBefore = 0;
+    uint32_t transitionsAdded = 0;
+    uint32_t transitionsAfter = 0;
+    uint32_t acceptingStatesAdded = 0;
+};
+
+inline Automaton removeEpsilon(const Automaton& fa, EpsilonRemovalStats* stats = nullptr) {
+    const uint32_t n = fa.numStates();
+    const uint32_t k = fa.numSymbols();
+
+    Automaton out;
+    out.states = fa.states;
+    out.symbols = fa.symbols;
+    out.declaredSymbols = fa.declaredSymbols;
+    out.start = fa.start;
+    out.accepting = fa.accepting;
+    out.hasRow.assign(n, 1);
+    out.byteSymbol = fa.byteSymbol;
+    out.epsOffsets.assign(n + 1, 0);
+
+    EpsilonRemovalStats local;
+    local.epsilonTransitionsRemoved = static_cast<uint32_t>(fa.epsTargets.size());
+    local.transitionsBefore = static_cast<uint32_t>(fa.targets.size());
+
+    EpsilonClosure closure(fa);
+    StateSet reach(n);
+    std::vector<StateId> others;
+    // stamp[t] == current row + 1 marks t as already emitted for this row
+    std::vector<uint32_t> stamp(n, 0);
+
+    out.offsets.assign(static_cast<size_t>(n) * k + 1, 0);
+    out.targets.reserve(fa.targets.size());
+
+    for (StateId p = 0; p < n; p++) {
+        reach.clear();
+        closure.closeState(p, reach);
+
+        // p's own transitions go first so they are never counted as added
+        others.clear();
+        reach.forEach([&](StateId q) {
+            if (q != p) others.push_back(q);
+            if (fa.accepting[q] && !out.accepting[p]) {
+                out.accepting[p] = 1;
+                local.acceptingStatesAdded++;
+            }
+        });
+
+        for (SymbolId c = 0; c < k; c++) {
+            uint32_t row = out.row(p, c);
+            out.offsets[row] = static_cast<uint32_t>(out.targets.size());
+
+            for (const StateId* t = fa.targetsBegin(p, c); t != fa.targetsEnd(p, c); ++t) {
+                if (stamp[*t] != row + 1) {
+                    stamp[*t] = row + 1;
+                    out.targets.push_back(*t);
+                }
+            }
+            for (StateId q : others) {
+                for (const StateId* t = fa.targetsBegin(q, c); t != fa.targetsEnd(q, c); ++t) {
+                    if (stamp[*t] != row + 1) {
+                        stamp[*t] = row + 1;
+                        out.targets.push_back(*t);
+                        local.transitionsAdded++;
+                    }
+                }
+            }
+        }
+    }
+    out.offsets[static_cast<size_t>(n) * k] = static_cast<uint32_t>(out.targets.size());
+    local.transitionsAfter = static_cast<uint32_t>(out.targets.size());
+
+    if (stats) {
+        *stats = local;
+    }
+    return out;
+}
+
+} // namespace automata
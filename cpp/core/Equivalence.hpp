@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DenseDFA.hpp"
+#include "Product.hpp"
+
+// Language equivalence of two DFAs by Hopcroft and Karp's union-find check.
+//
+// Starting from the pair of start states, every pair of states that must be
+// equivalent is merged into one union-find class; a successor pair whose
+// states are already in the same class needs no further work, so at most
+// left + right states' worth of pairs are ever explored and neither DFA is
+// minimized. Pairs are explored breadth first, and the first pair that
+// disagrees on acceptance yields a shortest counterexample: a successor pair
+// skipped as already merged is linked to its class by pairs that are no
+// deeper, and one of those disagrees at least as early.
+//
+// Missing transitions, and symbols only one DFA knows, go to an explicit
+// rejecting DEAD node of that DFA.
+
+namespace automata {
+
+struct EquivalenceResult {
+    bool equivalent = true;
+    // A shortest word accepted by exactly one side, when not equivalent
+    std::vector<std::string> counterexample;
+    bool acceptedByLeft = false;
+    // Pairs of states that had to be compared
+    size_t pairsChecked = 0;
+};
+
+class UnionFind {
+public:
+    explicit UnionFind(uint32_t size) : parent(size), rank(size, 0) {
+        for (uint32_t i = 0; i < size; i++) {
+            parent[i] = i;
+        }
+    }
+
+    uint32_t find(uint32_t x) {
+        // Path halving
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // False when already in the same class
+    bool unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (rank[a] < rank[b]) std::swap(a, b);
+        parent[b] = a;
+        if (rank[a] == rank[b]) rank[a]++;
+        return true;
+    }
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<uint8_t> rank;
+};
+
+inline EquivalenceResult dfaEquivalence(const NamedDFA& left, const NamedDFA& right) {
+    AlphabetUnion alphabet = unionAlphabet(left, right);
+    const uint32_t k = static_cast<uint32_t>(alphabet.symbols.size());
+
+    // Nodes: left states, left DEAD, right states, right DEAD
+    const uint32_t leftDead = left.table.numStates;
+    const uint32_t rightBase = leftDead + 1;
+    const uint32_t rightDead = rightBase + right.table.numStates;
+    auto leftNode = [&](StateId s) { return s == DenseDFA::DEAD ? leftDead : s; };
+    auto rightNode = [&](StateId s) { return s == DenseDFA::DEAD ? rightDead : rightBase + s; };
+    auto accepts = [&](uint32_t node) {
+        if (node < leftDead) return left.table.accepting[node] != 0;
+        if (node > leftDead && node < rightDead) return right.table.accepting[node - rightBase] != 0;
+        return false;
+    };
+    auto leftNext = [&](uint32_t node, SymbolId c) {
+        return node == leftDead ? leftDead : leftNode(left.table.next(node, alphabet.leftColumn[c]));
+    };
+    auto rightNext = [&](uint32_t node, SymbolId c) {
+        return node == rightDead ? rightDead : rightNode(right.table.next(node - rightBase, alphabet.rightColumn[c]));
+    };
+
+    struct Pair {
+        uint32_t left;
+        uint32_t right;
+        // Pair this one was reached from and the symbol read
+        uint32_t parent;
+        SymbolId symbol;
+    };
+
+    UnionFind classes(rightDead + 1);
+    std::vector<Pair> pairs;
+    pairs.push_back({leftNode(left.table.start), rightNode(right.table.start), NO_ID, NO_ID});
+    classes.unite(pairs[0].left, pairs[0].right);
+
+    EquivalenceResult result;
+    // The pair list doubles as the breadth-first queue
+    for (uint32_t i = 0; i < pairs.size(); i++) {
+        Pair current = pairs[i];
+        if (accepts(current.left) != accepts(current.right)) {
+            result.equivalent = false;
+            result.acceptedByLeft = accepts(current.left);
+            for (uint32_t p = i; pairs[p].parent != NO_ID; p = pairs[p].parent) {
+                result.counterexample.push_back(alphabet.symbols[pairs[p].symbol]);
+            }
+            std::reverse(result.counterexample.begin(), result.counterexample.end());
+            break;
+        }
+        for (SymbolId c = 0; c < k; c++) {
+            uint32_t a = leftNext(current.left, c);
+            uint32_t b = rightNext(current.right, c);
+            if (classes.unite(a, b)) {
+                pairs.push_back({a, b, i, c});
+            }
+        }
+    }
+    result.pairsChecked = pairs.size();
+    return result;
+}
+
+} // namespace automata
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Automaton.hpp"
+#include "Determinize.hpp"
+#include "EpsilonClosure.hpp"
+#include "Equivalence.hpp"
+#include "StateSet.hpp"
+
+// Language inclusion of NFAs with antichains, without determinizing either.
+//
+// Inclusion L(left) ⊆ L(right) fails exactly when some word leads left to an
+// accepting state while the subset of right reached on it has none. The
+// search explores pairs (left state, right subset) breadth first, and keeps
+// for each left state only the pairs whose subsets are minimal: a pair whose
+// subset contains that of an earlier pair for the same left state can fail
+// no sooner, so it is dropped, and a new pair supersedes the stored pairs
+// whose subsets contain its own. The subsets compared this way are usually
+// far fewer than the subset construction of right would build, and the
+// pairs that survive are stored as bitsets.
+//
+// Right moves on the same symbols by name; a symbol right does not know
+// leaves it with the empty subset.
+
+namespace automata {
+
+struct InclusionResult {
+    bool included = true;
+    // A word accepted by left but not by right, when not included
+    std::vector<std::string> counterexample;
+    // Pairs kept in the antichain at some point
+    size_t pairsChecked = 0;
+};
+
+inline InclusionResult nfaInclusion(const Automaton& left, const Automaton& right) {
+    std::vector<SymbolId> rightSymbol(left.numSymbols());
+    for (SymbolId c = 0; c < left.numSymbols(); c++) {
+        rightSymbol[c] = right.symbols.find(left.symbols.name(c));
+    }
+    EpsilonClosure leftClosure(left);
+    EpsilonClosure rightClosure(right);
+    StateSet rightAccepting = acceptingSet(right);
+
+    struct Pair {
+        StateId state;
+        StateSet subset;
+        // Pair this one was reached from and the symbol read
+        uint32_t parent;
+        SymbolId symbol;
+        bool superseded;
+    };
+    std::vector<Pair> pairs;
+    // Left state -> indices of its pairs with minimal subsets
+    std::vector<std::vector<uint32_t>> antichain(left.numStates());
+
+    auto add = [&](StateId state, const StateSet& subset, uint32_t parent, SymbolId symbol) {
+        std::vector<uint32_t>& kept = antichain[state];
+        for (uint32_t i : kept) {
+            if (pairs[i].subset.isSubsetOf(subset)) return;
+        }
+        kept.erase(std::remove_if(kept.begin(), kept.end(), [&](uint32_t i) {
+            if (!subset.isSubsetOf(pairs[i].subset)) return false;
+            pairs[i].superseded = true;
+            return true;
+        }), kept.end());
+        kept.push_back(static_cast<uint32_t>(pairs.size()));
+        pairs.push_back({state, subset, parent, symbol, false});
+    };
+
+    StateSet leftStates(left.numStates());
+    StateSet rightStates(right.numStates());
+    leftClosure.closeState(left.start, leftStates);
+    rightClosure.closeState(right.start, rightStates);
+    leftStates.forEach([&](StateId state) { add(state, rightStates, NO_ID, NO_ID); });
+
+    InclusionResult result;
+    StateSet moveResult(right.numStates());
+    // The pair list doubles as the breadth-first queue
+    for (uint32_t i = 0; i < pairs.size(); i++) {
+        if (pairs[i].superseded) continue;
+        StateId state = pairs[i].state;
+        if (left.accepting[state] && !pairs[i].subset.intersects(rightAccepting)) {
+            result.included = false;
+            for (uint32_t p = i; pairs[p].parent != NO_ID; p = pairs[p].parent) {
+                result.counterexample.push_back(left.symbols.name(pairs[p].symbol));
+            }
+            std::reverse(result.counterexample.begin(), result.counterexample.end());
+            break;
+        }
+
+        for (SymbolId c = 0; c < left.numSymbols(); c++) {
+            if (left.targetCount(state, c) == 0) continue;
+
+            rightStates.clear();
+            if (rightSymbol[c] != NO_ID) {
+                move(pairs[i].subset, rightSymbol[c], right, moveResult);
+                rightClosure.close(moveResult, rightStates);
+            }
+            leftStates.clear();
+            for (const StateId* t = left.targetsBegin(state, c); t != left.targetsEnd(state, c); ++t) {
+                leftClosure.closeState(*t, leftStates);
+            }
+            leftStates.forEach([&](StateId next) { add(next, rightStates, i, c); });
+        }
+    }
+    result.pairsChecked = pairs.size();
+    return result;
+}
+
+// Inclusion both ways; the counterexample comes from the first that fails
+inline EquivalenceResult nfaEquivalence(const Automaton& left, const Automaton& right) {
+    EquivalenceResult result;
+    InclusionResult forward = nfaInclusion(left, right);
+    result.pairsChecked = forward.pairsChecked;
+    if (!forward.included) {
+        result.equivalent = false;
+        result.counterexample = std::move(forward.counterexample);
+        result.acceptedByLeft = true;
+        return result;
+    }
+
+    InclusionResult backward = nfaInclusion(right, left);
+    result.pairsChecked += backward.pairsChecked;
+    if (!backward.included) {
+        result.equivalent = false;
+        result.counterexample = std::move(backward.counterexample);
+    }
+    return result;
+}
+
+} // namespace automata
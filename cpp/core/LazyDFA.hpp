@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "Determinize.hpp"
+#include "EpsilonClosure.hpp"
+#include "Liveness.hpp"
+#include "StateSet.hpp"
+
+// On-demand subset construction for NFA simulation.
+//
+// Each distinct epsilon-closed subset reached while reading input becomes a
+// cached DFA state, and its transition on a symbol is computed the first
+// time that symbol is read from it. After warm-up, a step is a single table
+// load as in a real DFA, but only the subsets the inputs actually visit
+// are built, so NFAs whose full determinization would blow up
+// exponentially remain usable.
+//
+// The cache is bounded by an estimate of its memory use. When a new state
+// would exceed the limit, the whole cache is flushed and rebuilt from the
+// state being entered (the policy RE2 uses): IDs handed out before a flush
+// become invalid, so callers only hold on to the ID returned by the last
+// start() or next() call.
+//
+// Every cached state also gets a verdict (see core/Liveness.hpp) from the
+// NFA's live states and accept sinks.
+
+namespace automata {
+
+class LazyDFA {
+public:
+    static constexpr StateId DEAD = NO_ID;
+    static constexpr size_t DEFAULT_CACHE_LIMIT = size_t(8) << 20;
+
+    explicit LazyDFA(const Automaton& nfa, size_t cacheLimit = DEFAULT_CACHE_LIMIT)
+        : nfa(nfa), closure(nfa), acceptingStates(acceptingSet(nfa)), liveNFAStates(liveStates(nfa)),
+          sinkNFAStates(acceptSinks(nfa)), stride(nfa.numSymbols()),
+          cacheLimit(cacheLimit), startSet(nfa.numStates()), moveResult(nfa.numStates()),
+          target(nfa.numStates()) {
+        if (nfa.start != NO_ID) {
+            closure.closeState(nfa.start, startSet);
+        }
+    }
+
+    StateId start() {
+        if (startId == NO_ID) {
+            startId = startSet.empty() ? DEAD : addState(startSet);
+        }
+        return startId;
+    }
+
+    // Transition on `symbol`; unknown symbols (NO_ID) lead to DEAD
+    StateId next(StateId state, SymbolId symbol) {
+        if (state == DEAD || symbol >= stride) {
+            return DEAD;
+        }
+
+        StateId& cached = table[static_cast<size_t>(state) * stride + symbol];
+        if (cached != UNKNOWN) {
+            return cached;
+        }
+
+        move(subsets[state], symbol, nfa, moveResult);
+        if (moveResult.empty()) {
+            cached = DEAD;
+            return DEAD;
+        }
+        closure.close(moveResult, target);
+
+        auto it = index.find(target);
+        if (it != index.end()) {
+            cached = it->second;
+            return cached;
+        }
+
+        // `cached` points into the table, which a flush or growth invalidates
+        size_t slot = static_cast<size_t>(state) * stride + symbol;
+        if (memoryUsed + stateCost(target) > cacheLimit) {
+            flush();
+            return addState(target);
+        }
+        StateId id = addState(target);
+        table[slot] = id;
+        return id;
+    }
+
+    bool accepting(StateId state) const {
+        return state != DEAD && acceptingFlags[state];
+    }
+
+    Verdict verdict(StateId state) const {
+        return state == DEAD ? Verdict::Reject : static_cast<Verdict>(verdicts[state]);
+    }
+
+    // The NFA states making up a cached state
+    const StateSet& subset(StateId state) const { return subsets[state]; }
+
+    const StateSet& nfaAccepting() const { return acceptingStates; }
+
+    size_t cachedStates() const { return subsets.size(); }
+    size_t statesBuilt() const { return builtCount; }
+    size_t flushes() const { return flushCount; }
+
+private:
+    static constexpr StateId UNKNOWN = NO_ID - 1;
+
+    // Rough bytes per cached state: its transition row, the subset stored
+    // twice (state list and hash key) and hash node overhead
+    size_t stateCost(const StateSet& set) const {
+        return stride * sizeof(StateId) + 2 * set.words().size() * sizeof(uint64_t) + 64;
+    }
+
+    StateId addState(const StateSet& set) {
+        StateId id = static_cast<StateId>(subsets.size());
+        subsets.push_back(set);
+        index.emplace(set, id);
+        table.resize(table.size() + stride, UNKNOWN);
+        acceptingFlags.push_back(set.intersects(acceptingStates));
+        Verdict verdict = !set.intersects(liveNFAStates) ? Verdict::Reject
+                        : set.intersects(sinkNFAStates) ? Verdict::Accept
+                                                        : Verdict::Open;
+        verdicts.push_back(static_cast<uint8_t>(verdict));
+        memoryUsed += stateCost(set);
+        builtCount++;
+        return id;
+    }
+
+    void flush() {
+        subsets.clear();
+        index.clear();
+        table.clear();
+        acceptingFlags.clear();
+        verdicts.clear();
+        memoryUsed = 0;
+        startId = NO_ID;
+        flushCount++;
+    }
+
+    const Automaton& nfa;
+    EpsilonClosure closure;
+    StateSet acceptingStates;
+    StateSet liveNFAStates;
+    StateSet sinkNFAStates;
+    uint32_t stride;
+    size_t cacheLimit;
+
+    std::vector<StateSet> subsets;
+    std::unordered_map<StateSet, StateId, StateSetHash> index;
+    std::vector<StateId> table;
+    std::vector<uint8_t> acceptingFlags;
+    std::vector<uint8_t> verdicts;
+    size_t memoryUsed = 0;
+    size_t flushCount = 0;
+    size_t builtCount = 0;
+
+    StateSet startSet;
+    StateId startId = NO_ID;
+    StateSet moveResult;
+    StateSet target;
+};
+
+} // namespace automata
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Automaton.hpp"
+#include "DenseDFA.hpp"
+#include "StateSet.hpp"
+
+// States whose outcome no longer depends on the rest of the input.
+//
+// A state from which no accepting state is reachable rejects whatever
+// follows, and an accepting state all of whose successors are again such
+// "accept sinks" accepts whatever follows, as long as it is made of alphabet
+// symbols. Runners check the verdict of the current state after every step:
+// a rejection ends the run, and after an accept sink only the alphabet
+// membership of the rest is checked, which needs no state and no chain of
+// dependent table loads. On long inputs most outcomes are decided within
+// the first few hundred bytes.
+
+namespace automata {
+
+enum class Verdict : uint8_t {
+    Open,   // the outcome depends on the rest of the input
+    Reject, // no accepting state is reachable any more
+    Accept, // every continuation over the alphabet is accepted
+};
+
+// Verdicts for a dense states x stride table in which missing transitions
+// are NO_ID; `alphabetColumns` flags the columns that stand for symbols
+// (as opposed to unknown input). The result is indexed by state + 1, with
+// slot 0 (Reject) standing for NO_ID itself, so `verdicts[state + 1]` needs
+// no DEAD check: unsigned overflow maps NO_ID to 0.
+inline std::vector<uint8_t> stateVerdicts(uint32_t numStates, uint32_t stride, const std::vector<StateId>& table,
+                                          const std::vector<uint8_t>& accepting,
+                                          const std::vector<uint8_t>& alphabetColumns) {
+    // Predecessor lists in CSR form
+    std::vector<uint32_t> offsets(static_cast<size_t>(numStates) + 1, 0);
+    for (StateId target : table) {
+        if (target != NO_ID) offsets[target + 1]++;
+    }
+    for (uint32_t s = 0; s < numStates; s++) {
+        offsets[s + 1] += offsets[s];
+    }
+    std::vector<StateId> predecessors(offsets.back());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (StateId s = 0; s < numStates; s++) {
+        for (uint32_t c = 0; c < stride; c++) {
+            StateId target = table[static_cast<size_t>(s) * stride + c];
+            if (target != NO_ID) predecessors[fill[target]++] = s;
+        }
+    }
+
+    // Marks everything that can reach a marked state
+    auto reachBackward = [&](std::vector<uint8_t>& marked) {
+        std::vector<StateId> stack;
+        for (StateId s = 0; s < numStates; s++) {
+            if (marked[s]) stack.push_back(s);
+        }
+        while (!stack.empty()) {
+            StateId s = stack.back();
+            stack.pop_back();
+            for (uint32_t i = offsets[s]; i < offsets[s + 1]; i++) {
+                if (!marked[predecessors[i]]) {
+                    marked[predecessors[i]] = 1;
+                    stack.push_back(predecessors[i]);
+                }
+            }
+        }
+    };
+
+    std::vector<uint8_t> live(accepting.begin(), accepting.end());
+    reachBackward(live);
+
+    // Not an accept sink: non-accepting, missing a symbol's transition, or
+    // able to reach such a state
+    std::vector<uint8_t> escapes(numStates, 0);
+    for (StateId s = 0; s < numStates; s++) {
+        const StateId* row = table.data() + static_cast<size_t>(s) * stride;
+        escapes[s] = !accepting[s];
+        for (uint32_t c = 0; c < stride && !escapes[s]; c++) {
+            escapes[s] = alphabetColumns[c] && row[c] == NO_ID;
+        }
+    }
+    reachBackward(escapes);
+
+    std::vector<uint8_t> verdicts(static_cast<size_t>(numStates) + 1);
+    verdicts[0] = static_cast<uint8_t>(Verdict::Reject);
+    for (StateId s = 0; s < numStates; s++) {
+        Verdict verdict = !live[s] ? Verdict::Reject : !escapes[s] ? Verdict::Accept : Verdict::Open;
+        verdicts[s + 1] = static_cast<uint8_t>(verdict);
+    }
+    return verdicts;
+}
+
+inline std::vector<uint8_t> stateVerdicts(const DenseDFA& dfa) {
+    // Every column but the extra DEAD one is a symbol
+    std::vector<uint8_t> alphabetColumns(dfa.stride, 1);
+    alphabetColumns[dfa.numSymbols] = 0;
+    return stateVerdicts(dfa.numStates, dfa.stride, dfa.table, dfa.accepting, alphabetColumns);
+}
+
+inline Verdict verdictOf(const std::vector<uint8_t>& verdicts, StateId state) {
+    return static_cast<Verdict>(verdicts[static_cast<StateId>(state + 1)]);
+}
+
+// NFA states from which an accepting state is reachable, over symbol and
+// epsilon edges. A simulated state set that misses all of them rejects.
+inline StateSet liveStates(const Automaton& fa) {
+    const uint32_t n = fa.numStates();
+    std::vector<std::vector<StateId>> predecessors(n);
+    for (StateId s = 0; s < n; s++) {
+        for (SymbolId c = 0; c < fa.numSymbols(); c++) {
+            for (const StateId* t = fa.targetsBegin(s, c); t != fa.targetsEnd(s, c); ++t) {
+                predecessors[*t].push_back(s);
+            }
+        }
+        for (const StateId* t = fa.epsilonBegin(s); t != fa.epsilonEnd(s); ++t) {
+            predecessors[*t].push_back(s);
+        }
+    }
+
+    StateSet live = acceptingSet(fa);
+    std::vector<StateId> stack;
+    live.forEach([&](StateId s) { stack.push_back(s); });
+    while (!stack.empty()) {
+        StateId s = stack.back();
+        stack.pop_back();
+        for (StateId p : predecessors[s]) {
+            if (live.insertNew(p)) stack.push_back(p);
+        }
+    }
+    return live;
+}
+
+// NFA accept sinks: accepting states with, for every symbol, a transition
+// into another accept sink. A simulated set containing one accepts any
+// continuation made of symbols. Computed as a greatest fixpoint by
+// counting, per (state, symbol) row, the targets that are still candidates.
+inline StateSet acceptSinks(const Automaton& fa) {
+    const uint32_t n = fa.numStates();
+    const uint32_t numSymbols = fa.numSymbols();
+    std::vector<uint32_t> remaining(static_cast<size_t>(n) * numSymbols, 0);
+    std::vector<std::vector<uint32_t>> incomingRows(n);
+    for (StateId s = 0; s < n; s++) {
+        for (SymbolId c = 0; c < numSymbols; c++) {
+            for (const StateId* t = fa.targetsBegin(s, c); t != fa.targetsEnd(s, c); ++t) {
+                incomingRows[*t].push_back(fa.row(s, c));
+                remaining[fa.row(s, c)] += fa.accepting[*t];
+            }
+        }
+    }
+
+    StateSet sinks = acceptingSet(fa);
+    std::vector<StateId> removed;
+    for (StateId s = 0; s < n; s++) {
+        if (!sinks.contains(s)) {
+            removed.push_back(s);
+            continue;
+        }
+        for (SymbolId c = 0; c < numSymbols; c++) {
+            if (remaining[fa.row(s, c)] == 0) {
+                sinks.erase(s);
+                removed.push_back(s);
+                break;
+            }
+        }
+    }
+
+    while (!removed.empty()) {
+        StateId t = removed.back();
+        removed.pop_back();
+        if (!fa.accepting[t]) continue; // never counted
+        for (uint32_t row : incomingRows[t]) {
+            StateId s = row / numSymbols;
+            if (--remaining[row] == 0 && sinks.contains(s)) {
+                sinks.erase(s);
+                removed.push_back(s);
+            }
+        }
+    }
+    return sinks;
+}
+
+} // namespace automata
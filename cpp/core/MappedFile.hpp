@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole input file.
+//
+// Scanning a mapping avoids copying the input through stdio buffers. On
+// POSIX the kernel is told the access is sequential (aggressive read-ahead,
+// pages dropped behind the scan) and that the whole range will be needed, so
+// it starts reading ahead before the first page fault.
+// isOpen() is false when the file cannot be mapped (pipes, special files),
+// so callers can fall back to chunked reads.
+
+namespace automata {
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) return;
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length == 0) {
+            opened = true;
+            return;
+        }
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        base = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        opened = base != nullptr;
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return;
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) {
+            opened = true;
+            return;
+        }
+
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) return;
+        base = static_cast<const char*>(p);
+        opened = true;
+
+        madvise(p, length, MADV_SEQUENTIAL);
+        madvise(p, length, MADV_WILLNEED);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (base) munmap(const_cast<char*>(base), length);
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char* base = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+} // namespace automata
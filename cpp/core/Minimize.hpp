@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "ByteClasses.hpp"
+#include "DenseDFA.hpp"
+
+// DFA minimization by Hopcroft's partition refinement, O(k n log n). The
+// result has one state per equivalence class, named after its
+// representative (the start state, else the smallest name). When the input
+// is partial, the class of states that can never reach acceptance is
+// removed and its transitions stay missing; only a start state in that
+// class is kept, as a lone rejecting state.
+//
+// States are normally told apart by their accept bit. Passing `labels` (one
+// per state, 0 for non-accepting) refines on the labels instead, so states
+// that accept different things are never merged; `labels_out` then receives
+// the label of every minimized state.
+
+namespace automata {
+
+inline NamedDFA minimizeDFA(const NamedDFA &input, const std::vector<uint32_t> *labels = nullptr,
+                            std::vector<uint32_t> *labels_out = nullptr) {
+    const DenseDFA &dfa = input.table;
+    const uint32_t k = dfa.numSymbols;
+
+    // Step 1: Remove unreachable states
+    std::vector<bool> reachable(dfa.numStates, false);
+    std::vector<StateId> states_vec;
+    std::queue<StateId> q;
+    q.push(dfa.start);
+    reachable[dfa.start] = true;
+    bool partial = false;
+
+    while (!q.empty()) {
+        StateId current = q.front(); q.pop();
+        states_vec.push_back(current);
+        for (SymbolId c = 0; c < k; c++) {
+            StateId next_state = dfa.next(current, c);
+            if (next_state == DenseDFA::DEAD) {
+                partial = true;
+            } else if (!reachable[next_state]) {
+                reachable[next_state] = true;
+                q.push(next_state);
+            }
+        }
+    }
+
+    // Step 2: Create optimized data structures
+    // Missing transitions go to an implicit non-accepting dead state, which
+    // gets the last index so partial DFAs are compared as if completed
+    int real = states_vec.size();
+    int n = real + (partial ? 1 : 0);
+    int dead_idx = real;
+
+    // Create state-to-index mapping for O(1) lookups
+    std::vector<int> state_to_idx(dfa.numStates, -1);
+    for (int i = 0; i < real; i++) {
+        state_to_idx[states_vec[i]] = i;
+    }
+
+    auto next_idx = [&](int i, SymbolId c) {
+        if (i == dead_idx) return dead_idx;
+        StateId next_state = dfa.next(states_vec[i], c);
+        return next_state == DenseDFA::DEAD ? dead_idx : state_to_idx[next_state];
+    };
+
+    // The implicit dead state is non-accepting, label 0
+    auto initial_label = [&](int i) -> uint32_t {
+        if (i == dead_idx) return 0;
+        if (labels) return (*labels)[states_vec[i]];
+        return dfa.accepting[states_vec[i]] ? 1 : 0;
+    };
+
+    // Step 3: Hopcroft partition refinement
+    // Symbols that every state maps identically split blocks identically, so
+    // only one symbol per column class is refined on (see core/ByteClasses.hpp).
+    // A byte-level alphabet of 256 symbols usually collapses to a few classes.
+    std::vector<SymbolId> class_symbols;
+    for (SymbolId c : symbolClasses(dfa).representative) {
+        if (c < k) class_symbols.push_back(c);
+    }
+    const uint32_t kc = static_cast<uint32_t>(class_symbols.size());
+
+    // Inverse transitions in CSR form: sources of `state` on class `c` are
+    // inverse[inverse_offsets[c * n + state] .. inverse_offsets[c * n + state + 1])
+    std::vector<uint32_t> inverse_offsets(static_cast<size_t>(kc) * n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        for (uint32_t c = 0; c < kc; c++) {
+            inverse_offsets[static_cast<size_t>(c) * n + next_idx(i, class_symbols[c]) + 1]++;
+        }
+    }
+    for (size_t r = 1; r < inverse_offsets.size(); r++) {
+        inverse_offsets[r] += inverse_offsets[r - 1];
+    }
+    std::vector<int> inverse(inverse_offsets.back());
+    {
+        std::vector<uint32_t> fill(inverse_offsets.begin(), inverse_offsets.end() - 1);
+        for (int i = 0; i < n; i++) {
+            for (uint32_t c = 0; c < kc; c++) {
+                inverse[fill[static_cast<size_t>(c) * n + next_idx(i, class_symbols[c])]++] = i;
+            }
+        }
+    }
+
+    // Refinable partition: block b owns elements[first[b] .. last[b]), and
+    // marked states of a block are swapped to the front of its range
+    std::vector<int> elements(n), location(n), block_of(n);
+    std::vector<int> first, last, marked;
+
+    auto add_block = [&](int begin, int end) {
+        first.push_back(begin);
+        last.push_back(end);
+        marked.push_back(0);
+        for (int e = begin; e < end; e++) {
+            block_of[elements[e]] = static_cast<int>(first.size()) - 1;
+        }
+        return static_cast<int>(first.size()) - 1;
+    };
+
+    // Initial partition: one block per label
+    std::vector<uint32_t> initial(n);
+    for (int i = 0; i < n; i++) {
+        initial[i] = initial_label(i);
+        elements[i] = i;
+    }
+    std::stable_sort(elements.begin(), elements.end(), [&](int a, int b) { return initial[a] < initial[b]; });
+    for (int e = 0; e < n; e++) {
+        location[elements[e]] = e;
+    }
+    for (int begin = 0, end = 0; begin < n; begin = end) {
+        while (end < n && initial[elements[end]] == initial[elements[begin]]) end++;
+        add_block(begin, end);
+    }
+
+    // Worklist of (block, symbol class) splitters; there are at most n blocks
+    std::vector<uint8_t> in_worklist(static_cast<size_t>(n) * kc, 0);
+    std::vector<std::pair<int, uint32_t>> worklist;
+    auto push_splitter = [&](int b, uint32_t c) {
+        if (!in_worklist[static_cast<size_t>(b) * kc + c]) {
+            in_worklist[static_cast<size_t>(b) * kc + c] = 1;
+            worklist.push_back({b, c});
+        }
+    };
+
+    // Any one initial block is refined by the others, so the largest is left out
+    if (first.size() > 1) {
+        int largest = 0;
+        for (int b = 1; b < static_cast<int>(first.size()); b++) {
+            if (last[b] - first[b] > last[largest] - first[largest]) largest = b;
+        }
+        for (int b = 0; b < static_cast<int>(first.size()); b++) {
+            if (b == largest) continue;
+            for (uint32_t c = 0; c < kc; c++) push_splitter(b, c);
+        }
+    }
+
+    std::vector<int> predecessors;
+    std::vector<int> touched;
+    while (!worklist.empty()) {
+        auto [splitter, c] = worklist.back();
+        worklist.pop_back();
+        in_worklist[static_cast<size_t>(splitter) * kc + c] = 0;
+
+        // Every state has one successor per symbol, so predecessors are unique
+        predecessors.clear();
+        for (int e = first[splitter]; e < last[splitter]; e++) {
+            size_t r = static_cast<size_t>(c) * n + elements[e];
+            predecessors.insert(predecessors.end(), inverse.begin() + inverse_offsets[r], inverse.begin() + inverse_offsets[r + 1]);
+        }
+
+        touched.clear();
+        for (int p : predecessors) {
+            int b = block_of[p];
+            if (marked[b] == 0) touched.push_back(b);
+            int target = first[b] + marked[b]++;
+            int displaced = elements[target];
+            std::swap(elements[location[p]], elements[target]);
+            location[displaced] = location[p];
+            location[p] = target;
+        }
+
+        for (int b : touched) {
+            int size = last[b] - first[b];
+            int count = marked[b];
+            marked[b] = 0;
+            if (count == size) continue;
+
+            // The marked front part becomes a new block
+            int begin = first[b];
+            first[b] = begin + count;
+            int created = add_block(begin, begin + count);
+
+            for (uint32_t d = 0; d < kc; d++) {
+                if (in_worklist[static_cast<size_t>(b) * kc + d]) {
+                    push_splitter(created, d);
+                } else {
+                    push_splitter(count <= size - count ? created : b, d);
+                }
+            }
+        }
+    }
+
+    // Number classes in order of their first state, so the result does not
+    // depend on the order blocks were split in
+    std::vector<int> block_to_class(first.size(), -1);
+    int class_count = 0;
+    std::vector<int> class_id(n);
+
+    for (int i = 0; i < n; i++) {
+        int &cls = block_to_class[block_of[i]];
+        if (cls < 0) {
+            cls = class_count++;
+        }
+        class_id[i] = cls;
+    }
+
+    // Step 4: Build minimized DFA with optimized lookups
+    // Find a representative for each class (prefer start state, then lexicographically smallest).
+    // In a partial DFA the class of the implicit dead state holds the states
+    // that cannot reach acceptance: it gets no representative and becomes
+    // DEAD, so those states are removed, unless the start is among them,
+    // which then represents the class as a lone rejecting state.
+    const int dead_class = partial ? class_id[dead_idx] : -1;
+    const bool start_dead = class_id[state_to_idx[dfa.start]] == dead_class;
+    std::vector<StateId> class_representatives(class_count, NO_ID);
+    for (int i = 0; i < real; i++) {
+        int cls = class_id[i];
+        if (cls == dead_class && states_vec[i] != dfa.start) continue;
+        StateId state = states_vec[i];
+        StateId &rep = class_representatives[cls];
+        if (rep == NO_ID) {
+            rep = state;
+        } else if (state == dfa.start) {
+            // Prefer start state as representative
+            rep = state;
+        } else if (rep != dfa.start && input.states[state] < input.states[rep]) {
+            // Otherwise prefer lexicographically smaller state
+            rep = state;
+        }
+    }
+
+    std::vector<StateId> class_to_state(class_count, DenseDFA::DEAD);
+    uint32_t new_count = 0;
+    for (int i = 0; i < class_count; i++) {
+        if (class_representatives[i] != NO_ID) {
+            class_to_state[i] = new_count++;
+        }
+    }
+
+    NamedDFA new_dfa;
+    new_dfa.alphabet = input.alphabet;
+    new_dfa.table = DenseDFA(new_count, k);
+    if (labels_out) {
+        labels_out->assign(new_count, 0);
+    }
+
+    // Use the representative state name as the new state name
+    for (int i = 0; i < class_count; i++) {
+        StateId rep = class_representatives[i];
+        if (rep == NO_ID) continue;
+
+        StateId state = class_to_state[i];
+        new_dfa.states.push_back(input.states[rep]);
+        new_dfa.table.accepting[state] = dfa.accepting[rep];
+        if (labels_out) {
+            (*labels_out)[state] = initial_label(state_to_idx[rep]);
+        }
+
+        // Set transitions using representatives
+        if (start_dead && i == dead_class) continue;
+        for (SymbolId c = 0; c < k; c++) {
+            int next = class_id[next_idx(state_to_idx[rep], c)];
+            new_dfa.table.set(state, c, next == dead_class ? DenseDFA::DEAD : class_to_state[next]);
+        }
+    }
+
+    // Set start state - it keeps its name since we use representative names
+    new_dfa.table.start = class_to_state[class_id[state_to_idx[dfa.start]]];
+    indexByteSymbols(new_dfa);
+
+    return new_dfa;
+}
+
+} // namespace automata
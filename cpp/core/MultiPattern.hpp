@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "ByteClasses.hpp"
+#include "Determinize.hpp"
+#include "Minimize.hpp"
+#include "Runner.hpp"
+#include "Tokenizer.hpp"
+
+// Matching one input against many automata at once.
+//
+// The patterns are joined into one NFA whose fresh start state has epsilon
+// edges to every pattern's start, and that NFA is determinized and minimized
+// once. Every DFA state carries a label: the set of patterns with an
+// accepting state in its subset, interned so a state stores one ID (0 is the
+// empty set). Minimization starts from the partition by label rather than by
+// accept bit, so states accepting different patterns are never merged, and a
+// single pass over the input answers which of the patterns accept it.
+//
+// Patterns that share prefixes share states. Overlapping patterns with
+// unrelated structure can multiply out towards the product of their sizes,
+// so very large pattern sets are better split into several groups.
+
+namespace automata {
+
+struct MultiDFA {
+    NamedDFA dfa;
+    // Label of every state
+    std::vector<uint32_t> label;
+    // Label -> sorted pattern indices; labelSets[0] is empty
+    std::vector<std::vector<uint32_t>> labelSets;
+};
+
+// Disjoint union of the patterns behind a fresh start state. Pattern states
+// are renamed "<index>:<name>" and symbols are merged by name, including
+// those that only appear as transition keys. `patternOf` receives the
+// pattern index of every state (NO_ID for the new start).
+inline Automaton unionAutomaton(const std::vector<Automaton>& patterns, std::vector<uint32_t>& patternOf) {
+    Automaton u;
+    u.start = u.states.intern("start");
+    patternOf.assign(1, NO_ID);
+
+    std::vector<std::vector<SymbolId>> symbolMap(patterns.size());
+    std::vector<StateId> base(patterns.size());
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        for (const std::string& symbol : patterns[p].symbols.names) {
+            symbolMap[p].push_back(u.symbols.intern(symbol));
+        }
+        base[p] = u.numStates();
+        for (const std::string& state : patterns[p].states.names) {
+            u.states.intern(std::to_string(p) + ":" + state);
+            patternOf.push_back(p);
+        }
+    }
+    u.declaredSymbols = u.numSymbols();
+
+    const uint32_t n = u.numStates();
+    u.accepting.assign(n, 0);
+    u.hasRow.assign(n, 1);
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        for (StateId s = 0; s < patterns[p].numStates(); s++) {
+            u.accepting[base[p] + s] = patterns[p].accepting[s];
+        }
+    }
+
+    // Symbol IDs change, so the rows are counted and filled again
+    u.offsets.assign(static_cast<size_t>(n) * u.numSymbols() + 1, 0);
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        const Automaton& fa = patterns[p];
+        for (StateId s = 0; s < fa.numStates(); s++) {
+            for (SymbolId c = 0; c < fa.numSymbols(); c++) {
+                u.offsets[u.row(base[p] + s, symbolMap[p][c]) + 1] += fa.targetCount(s, c);
+            }
+        }
+    }
+    for (size_t i = 1; i < u.offsets.size(); i++) {
+        u.offsets[i] += u.offsets[i - 1];
+    }
+    u.targets.resize(u.offsets.back());
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        const Automaton& fa = patterns[p];
+        for (StateId s = 0; s < fa.numStates(); s++) {
+            for (SymbolId c = 0; c < fa.numSymbols(); c++) {
+                uint32_t fill = u.offsets[u.row(base[p] + s, symbolMap[p][c])];
+                for (const StateId* t = fa.targetsBegin(s, c); t != fa.targetsEnd(s, c); ++t) {
+                    u.targets[fill++] = base[p] + *t;
+                }
+            }
+        }
+    }
+
+    // The start's epsilon edges, then each pattern's own, in state order
+    u.epsOffsets.assign(1, 0);
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        u.epsTargets.push_back(base[p] + patterns[p].start);
+    }
+    u.epsOffsets.push_back(static_cast<uint32_t>(u.epsTargets.size()));
+    for (uint32_t p = 0; p < patterns.size(); p++) {
+        const Automaton& fa = patterns[p];
+        for (StateId s = 0; s < fa.numStates(); s++) {
+            for (const StateId* t = fa.epsilonBegin(s); t != fa.epsilonEnd(s); ++t) {
+                u.epsTargets.push_back(base[p] + *t);
+            }
+            u.epsOffsets.push_back(static_cast<uint32_t>(u.epsTargets.size()));
+        }
+    }
+
+    indexByteSymbols(u);
+    return u;
+}
+
+// Minimal DFA of the union, labelled with the patterns each state accepts
+inline MultiDFA buildMultiDFA(const std::vector<Automaton>& patterns) {
+    std::vector<uint32_t> patternOf;
+    Automaton nfa = unionAutomaton(patterns, patternOf);
+
+    std::vector<StateSet> subsets;
+    NamedDFA joint = determinize(nfa, false, &subsets);
+
+    MultiDFA multi;
+    multi.labelSets.emplace_back();
+    std::map<std::vector<uint32_t>, uint32_t> labelIds{{{}, 0}};
+    std::vector<uint32_t> labels(subsets.size());
+    std::vector<uint32_t> accepted;
+    for (size_t q = 0; q < subsets.size(); q++) {
+        // States are numbered pattern by pattern, so duplicates are adjacent
+        accepted.clear();
+        subsets[q].forEach([&](StateId s) {
+            if (nfa.accepting[s] && (accepted.empty() || accepted.back() != patternOf[s])) {
+                accepted.push_back(patternOf[s]);
+            }
+        });
+        auto inserted = labelIds.emplace(accepted, static_cast<uint32_t>(multi.labelSets.size()));
+        if (inserted.second) {
+            multi.labelSets.push_back(accepted);
+        }
+        labels[q] = inserted.first->second;
+    }
+
+    multi.dfa = minimizeDFA(joint, &labels, &multi.label);
+    return multi;
+}
+
+// Runs inputs through a MultiDFA. Accept sinks do not end a run here: the
+// set of accepting patterns can still change after one.
+class MultiMatcher {
+public:
+    MultiMatcher(const MultiDFA& multi, TokenMode mode)
+        : multi(multi), tokenizer(multi.dfa.alphabet, mode) {
+        if (mode == TokenMode::Byte) {
+            byteClasses = compressByteClasses(multi.dfa.table);
+            for (uint8_t& verdict : byteClasses.verdicts) {
+                if (verdict == static_cast<uint8_t>(Verdict::Accept)) {
+                    verdict = static_cast<uint8_t>(Verdict::Open);
+                }
+            }
+        }
+    }
+
+    const std::vector<uint32_t>& matchString(const std::string& input) const {
+        const DenseDFA& dfa = multi.dfa.table;
+        StateId state = dfa.start;
+        SymbolId symbol;
+        for (size_t pos = 0; pos < input.size() && state != DenseDFA::DEAD;) {
+            pos += tokenizer.next(input, pos, symbol);
+            state = stepSymbol(dfa, state, symbol);
+        }
+        return stateMatches(state);
+    }
+
+    const std::vector<uint32_t>& matchTokens(const std::vector<std::string>& tokens) const {
+        const DenseDFA& dfa = multi.dfa.table;
+        StateId state = dfa.start;
+        for (size_t i = 0; i < tokens.size() && state != DenseDFA::DEAD; i++) {
+            state = stepSymbol(dfa, state, tokenizer.find(tokens[i]));
+        }
+        return stateMatches(state);
+    }
+
+    // Byte mode only: all strings through the interleaved batch runner;
+    // `labels` receives one label ID per input
+    void matchBatch(const std::vector<const std::string*>& inputs, std::vector<uint32_t>& labels) const {
+        std::vector<BatchOutcome> outcomes;
+        runBatch(byteClasses, inputs, outcomes);
+        labels.resize(inputs.size());
+        for (size_t i = 0; i < inputs.size(); i++) {
+            labels[i] = outcomes[i].state == ByteClassDFA::DEAD ? 0 : multi.label[outcomes[i].state];
+        }
+    }
+
+    // Pattern indices of a label from matchBatch
+    const std::vector<uint32_t>& labelSet(uint32_t label) const { return multi.labelSets[label]; }
+
+private:
+    const std::vector<uint32_t>& stateMatches(StateId state) const {
+        return multi.labelSets[state == DenseDFA::DEAD ? 0 : multi.label[state]];
+    }
+
+    const MultiDFA& multi;
+    Tokenizer tokenizer;
+    ByteClassDFA byteClasses;
+};
+
+} // namespace automata
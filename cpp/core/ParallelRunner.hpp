@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "ByteClasses.hpp"
+#include "ShuffleDFA.hpp"
+
+// Multi-threaded DFA execution over one large in-memory input.
+//
+// The input is cut into one chunk per thread. The first chunk runs from the
+// start state as usual; every other chunk is run speculatively from several
+// states at once, producing part of its transition function (entry state ->
+// state after the chunk). Lanes that reach the same state are merged every
+// few dozen bytes, and for most DFAs they collapse to one or two lanes within
+// a few hundred bytes, so each thread does close to a single scan of its
+// chunk. Composing the functions in order gives the final state; a chunk
+// entered in a state it was not speculated from is scanned again.
+//
+// Small DFAs are speculated from every state. Larger ones only from the
+// states their lanes reach after the bytes just before the chunk, which is
+// where the real run most likely stands. Chunks whose lanes do not converge
+// within a probe window give up and are run normally once the state
+// entering them is known.
+
+namespace automata {
+
+struct ChunkFunction {
+    bool resolved = false;
+    // State after the chunk for each entry state it was speculated from
+    std::vector<StateId> entries;
+    std::vector<StateId> exits;
+
+    bool exit(StateId entry, StateId& out) const {
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i] == entry) {
+                out = exits[i];
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+inline StateId runChunk(const ByteClassDFA& dfa, StateId state, const char* data, size_t size) {
+    for (size_t i = 0; i < size && dfa.verdict(state) != Verdict::Reject; i++) {
+        state = dfa.step(state, static_cast<unsigned char>(data[i]));
+    }
+    return state;
+}
+
+// At most this many lanes per chunk; larger DFAs pick their entry states
+constexpr size_t SPECULATION_MAX_LANES = 16;
+// Lanes are merged after every block
+constexpr size_t SPECULATION_BLOCK_BYTES = 64;
+// A chunk with more live lanes than this after the probe window gives up
+constexpr size_t SPECULATION_MAX_LIVE_LANES = 4;
+constexpr size_t SPECULATION_PROBE_BYTES = 4096;
+// Bytes before the chunk used to pick the entry states of large DFAs
+constexpr size_t SPECULATION_LOOKBACK_BYTES = 4096;
+
+// Runs every lane over `data`, merging lanes that reach the same state.
+// laneOf[e] is the lane entry e ended up in. Returns false when more than
+// SPECULATION_MAX_LIVE_LANES lanes are alive after the probe window, if
+// `probe` is set.
+inline bool runLanes(const ByteClassDFA& dfa, std::vector<StateId>& lanes, std::vector<uint32_t>& laneOf,
+                     const char* data, size_t size, bool probe) {
+    std::vector<uint32_t> remap;
+    std::vector<StateId> merged;
+
+    size_t pos = 0;
+    while (pos < size && lanes.size() > 1) {
+        size_t end = std::min(size, pos + SPECULATION_BLOCK_BYTES);
+        for (StateId& state : lanes) {
+            state = runChunk(dfa, state, data + pos, end - pos);
+        }
+        pos = end;
+
+        // At most SPECULATION_MAX_LANES lanes, so a linear search is enough
+        remap.resize(lanes.size());
+        merged.clear();
+        for (size_t l = 0; l < lanes.size(); l++) {
+            size_t slot = std::find(merged.begin(), merged.end(), lanes[l]) - merged.begin();
+            if (slot == merged.size()) {
+                merged.push_back(lanes[l]);
+            }
+            remap[l] = static_cast<uint32_t>(slot);
+        }
+        for (uint32_t& lane : laneOf) {
+            lane = remap[lane];
+        }
+        lanes.swap(merged);
+
+        if (probe && pos >= SPECULATION_PROBE_BYTES && lanes.size() > SPECULATION_MAX_LIVE_LANES) {
+            return false;
+        }
+    }
+
+    // One lane left: finish with a plain scan
+    for (StateId& state : lanes) {
+        state = runChunk(dfa, state, data + pos, size - pos);
+    }
+    return true;
+}
+
+// Partial transition function of data[0, size). The `lookback` bytes before
+// `data` must be readable; they choose the entry states of large DFAs.
+inline ChunkFunction chunkFunction(const ByteClassDFA& dfa, const char* data, size_t size, size_t lookback) {
+    const uint32_t n = dfa.numStates;
+    std::vector<StateId> lanes;
+
+    if (n <= SPECULATION_MAX_LANES) {
+        lanes.resize(n);
+        std::iota(lanes.begin(), lanes.end(), 0);
+    } else {
+        // Seed from the start state and the first few others; the lookback
+        // usually merges them into the one state the real run is in
+        lanes.push_back(dfa.start);
+        for (StateId s = 0; lanes.size() < SPECULATION_MAX_LANES; s++) {
+            if (s != dfa.start) lanes.push_back(s);
+        }
+        std::vector<uint32_t> seedLanes(lanes.size());
+        std::iota(seedLanes.begin(), seedLanes.end(), 0);
+        runLanes(dfa, lanes, seedLanes, data - lookback, lookback, false);
+    }
+
+    ChunkFunction result;
+    result.entries = lanes;
+    std::vector<uint32_t> laneOf(lanes.size());
+    std::iota(laneOf.begin(), laneOf.end(), 0);
+    if (!runLanes(dfa, lanes, laneOf, data, size, true)) {
+        return ChunkFunction();
+    }
+
+    result.resolved = true;
+    result.exits.resize(result.entries.size());
+    for (size_t e = 0; e < result.entries.size(); e++) {
+        result.exits[e] = lanes[laneOf[e]];
+    }
+    return result;
+}
+
+// Smallest chunk worth a thread of its own
+constexpr size_t PARALLEL_MIN_CHUNK = 1 << 20;
+
+// State after running `data` from `state`, using up to `threads` threads.
+// DFAs that fit the shuffle kernel build every chunk function with it.
+inline StateId runParallel(const ByteClassDFA& dfa, StateId state, const char* data, size_t size, unsigned threads) {
+    std::unique_ptr<ShuffleDFA> shuffle(new ShuffleDFA());
+    if (!buildShuffleDFA(dfa, *shuffle)) {
+        shuffle.reset();
+    }
+    auto scan = [&](StateId from, const char* begin, size_t length) {
+        return shuffle ? runShuffle(*shuffle, from, begin, length) : runChunk(dfa, from, begin, length);
+    };
+
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, size / PARALLEL_MIN_CHUNK));
+    if (chunks == 1 || dfa.verdict(state) == Verdict::Reject) {
+        return scan(state, data, size);
+    }
+
+    size_t chunkSize = (size + chunks - 1) / chunks;
+    auto chunkBegin = [&](size_t i) { return std::min(size, i * chunkSize); };
+
+    StateId first = ByteClassDFA::DEAD;
+    std::vector<ChunkFunction> functions(chunks);
+    std::vector<std::thread> workers;
+    workers.emplace_back([&] { first = scan(state, data, chunkBegin(1)); });
+    for (size_t i = 1; i < chunks; i++) {
+        workers.emplace_back([&, i] {
+            const char* begin = data + chunkBegin(i);
+            size_t length = chunkBegin(i + 1) - chunkBegin(i);
+            if (shuffle && shuffleChunkFunction(*shuffle, begin, length, functions[i].exits)) {
+                functions[i].entries.resize(functions[i].exits.size());
+                std::iota(functions[i].entries.begin(), functions[i].entries.end(), 0);
+                functions[i].resolved = true;
+            } else {
+                size_t lookback = std::min(SPECULATION_LOOKBACK_BYTES, chunkBegin(i));
+                functions[i] = chunkFunction(dfa, begin, length, lookback);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    state = first;
+    for (size_t i = 1; i < chunks && dfa.verdict(state) != Verdict::Reject; i++) {
+        if (!functions[i].resolved || !functions[i].exit(state, state)) {
+            state = scan(state, data + chunkBegin(i), chunkBegin(i + 1) - chunkBegin(i));
+        }
+    }
+    return state;
+}
+
+} // namespace automata
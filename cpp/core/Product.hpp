@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Classify.hpp"
+#include "DenseDFA.hpp"
+#include "Determinize.hpp"
+
+// Product construction: one DFA running two DFAs side by side.
+//
+// Product states are pairs (left state, right state), discovered breadth
+// first from the pair of start states, so unreachable pairs are never
+// built. A pair is looked up by its two IDs packed into one 64-bit key. The
+// alphabet is the union of both alphabets; a symbol one side lacks, like a
+// missing transition, sends that side to DEAD, which stays in the pair for
+// the operations that can still accept without it. Pairs that can no longer
+// accept under the operation (both sides DEAD, or for an intersection either
+// side) are left out altogether, so the result is a partial DFA ready for
+// minimizeDFA.
+
+namespace automata {
+
+enum class ProductOp {
+    Intersection,
+    Union,
+    Difference, // left and not right
+    Xor,
+};
+
+inline ProductOp parseProductOp(const std::string& name) {
+    if (name == "intersection") return ProductOp::Intersection;
+    if (name == "union") return ProductOp::Union;
+    if (name == "difference") return ProductOp::Difference;
+    if (name == "xor") return ProductOp::Xor;
+    throw std::runtime_error("Unknown operation '" + name + "'; use intersection, union, difference or xor");
+}
+
+inline bool productAccepts(ProductOp op, bool left, bool right) {
+    switch (op) {
+    case ProductOp::Intersection: return left && right;
+    case ProductOp::Union: return left || right;
+    case ProductOp::Difference: return left && !right;
+    default: return left != right;
+    }
+}
+
+// The automaton as a DFA over all of its symbols, including those that only
+// appear as transition keys; determinized only when it is not already
+// deterministic
+inline NamedDFA toDFA(Automaton fa) {
+    fa.declaredSymbols = fa.numSymbols();
+    return isDeterministic(fa) ? namedDFA(fa) : determinize(fa);
+}
+
+// The union of two DFAs' alphabets, left symbols first
+struct AlphabetUnion {
+    std::vector<std::string> symbols;
+    // Column of each symbol in either DFA; a symbol a DFA lacks maps to its
+    // all-DEAD column
+    std::vector<SymbolId> leftColumn;
+    std::vector<SymbolId> rightColumn;
+};
+
+inline AlphabetUnion unionAlphabet(const NamedDFA& left, const NamedDFA& right) {
+    AlphabetUnion alphabet;
+    alphabet.symbols = left.alphabet;
+    std::unordered_map<std::string, SymbolId> symbolIndex;
+    for (SymbolId c = 0; c < left.alphabet.size(); c++) {
+        symbolIndex.emplace(left.alphabet[c], c);
+    }
+    for (const std::string& symbol : right.alphabet) {
+        if (symbolIndex.emplace(symbol, static_cast<SymbolId>(alphabet.symbols.size())).second) {
+            alphabet.symbols.push_back(symbol);
+        }
+    }
+
+    alphabet.leftColumn.assign(alphabet.symbols.size(), left.table.numSymbols);
+    alphabet.rightColumn.assign(alphabet.symbols.size(), right.table.numSymbols);
+    for (SymbolId c = 0; c < left.alphabet.size(); c++) {
+        alphabet.leftColumn[c] = c;
+    }
+    for (SymbolId c = 0; c < right.alphabet.size(); c++) {
+        alphabet.rightColumn[symbolIndex[right.alphabet[c]]] = c;
+    }
+    return alphabet;
+}
+
+// Product states are named q0, q1, ... in discovery order
+inline NamedDFA productDFA(const NamedDFA& left, const NamedDFA& right, ProductOp op) {
+    AlphabetUnion alphabet = unionAlphabet(left, right);
+    const std::vector<SymbolId>& leftColumn = alphabet.leftColumn;
+    const std::vector<SymbolId>& rightColumn = alphabet.rightColumn;
+    const uint32_t k = static_cast<uint32_t>(alphabet.symbols.size());
+
+    NamedDFA product;
+    product.alphabet = std::move(alphabet.symbols);
+    product.table = DenseDFA(0, k);
+    indexByteSymbols(product);
+
+    // Only pairs that can still reach acceptance are kept
+    auto viable = [op](StateId a, StateId b) {
+        switch (op) {
+        case ProductOp::Intersection: return a != DenseDFA::DEAD && b != DenseDFA::DEAD;
+        case ProductOp::Difference: return a != DenseDFA::DEAD;
+        default: return a != DenseDFA::DEAD || b != DenseDFA::DEAD;
+        }
+    };
+
+    std::vector<std::pair<StateId, StateId>> pairs;
+    std::unordered_map<uint64_t, StateId> pairIndex;
+
+    auto addState = [&](StateId a, StateId b) {
+        uint64_t key = (static_cast<uint64_t>(a) << 32) | b;
+        auto it = pairIndex.find(key);
+        if (it != pairIndex.end()) {
+            return it->second;
+        }
+
+        StateId id = product.table.addState();
+        bool leftAccepts = a != DenseDFA::DEAD && left.table.accepting[a];
+        bool rightAccepts = b != DenseDFA::DEAD && right.table.accepting[b];
+        product.table.accepting[id] = productAccepts(op, leftAccepts, rightAccepts);
+        product.states.push_back("q" + std::to_string(id));
+        pairs.emplace_back(a, b);
+        pairIndex.emplace(key, id);
+        return id;
+    };
+
+    product.table.start = addState(left.table.start, right.table.start);
+    if (!viable(left.table.start, right.table.start)) {
+        // Nothing can be accepted: a single rejecting start state
+        return product;
+    }
+
+    // States are processed in discovery order, so the id doubles as the queue
+    for (StateId current = 0; current < product.table.numStates; current++) {
+        auto [a, b] = pairs[current];
+        for (SymbolId c = 0; c < k; c++) {
+            StateId nextA = a == DenseDFA::DEAD ? DenseDFA::DEAD : left.table.next(a, leftColumn[c]);
+            StateId nextB = b == DenseDFA::DEAD ? DenseDFA::DEAD : right.table.next(b, rightColumn[c]);
+            if (viable(nextA, nextB)) {
+                product.table.set(current, c, addState(nextA, nextB));
+            }
+        }
+    }
+
+    return product;
+}
+
+// Shortest accepted word, as symbols, or nothing if the language is empty.
+// Breadth first from the start, ties broken by symbol order.
+inline std::optional<std::vector<std::string>> shortestAccepted(const NamedDFA& dfa) {
+    const DenseDFA& t = dfa.table;
+    if (t.start == DenseDFA::DEAD) {
+        return std::nullopt;
+    }
+
+    std::vector<StateId> parent(t.numStates, NO_ID);
+    std::vector<SymbolId> via(t.numStates, NO_ID);
+    std::vector<StateId> queue{t.start};
+    parent[t.start] = t.start;
+    for (size_t head = 0; head < queue.size(); head++) {
+        StateId s = queue[head];
+        if (t.accepting[s]) {
+            std::vector<std::string> word;
+            for (; s != t.start; s = parent[s]) {
+                word.push_back(dfa.alphabet[via[s]]);
+            }
+            return std::vector<std::string>(word.rbegin(), word.rend());
+        }
+        for (SymbolId c = 0; c < t.numSymbols; c++) {
+            StateId next = t.next(s, c);
+            if (next != DenseDFA::DEAD && parent[next] == NO_ID) {
+                parent[next] = s;
+                via[next] = c;
+                queue.push_back(next);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace automata
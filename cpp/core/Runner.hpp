@@ -0,0 +1,222 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ByteClasses.hpp"
+#include "DenseDFA.hpp"
+#include "Liveness.hpp"
+#include "Tokenizer.hpp"
+
+// DFA execution on the dense table, over raw input bytes or over the
+// symbols produced by a Tokenizer.
+
+namespace automata {
+
+inline bool testDFA(const DenseDFA& dfa, const std::string& input) {
+    StateId current = dfa.start;
+
+    for (char c : input) {
+        current = dfa.step(current, static_cast<unsigned char>(c));
+        if (current == DenseDFA::DEAD) {
+            return false;
+        }
+    }
+    return dfa.accepting[current] != 0;
+}
+
+// Outcome of a run that stops consulting the automaton once the outcome is
+// decided (core/Liveness.hpp)
+struct RunResult {
+    bool accepted;
+    // Bytes or symbols read when the automaton decided: by a missing
+    // transition (counting the symbol that had none), a dead state or an
+    // accept sink; the input length when only the end decided
+    size_t decidedAt;
+};
+
+inline RunResult runDFA(const ByteClassDFA& dfa, const std::string& input) {
+    StateId current = dfa.start;
+    size_t pos = 0;
+
+    while (pos < input.size() && dfa.verdict(current) == Verdict::Open) {
+        current = dfa.step(current, static_cast<unsigned char>(input[pos++]));
+    }
+    switch (dfa.verdict(current)) {
+    case Verdict::Reject:
+        return {false, pos};
+    case Verdict::Accept: {
+        // The rest only has to be made of symbols
+        size_t unknown = dfa.findNonAlphabet(input.data(), pos, input.size());
+        return unknown < input.size() ? RunResult{false, unknown + 1} : RunResult{true, pos};
+    }
+    default:
+        return {dfa.accepting[current] != 0, pos};
+    }
+}
+
+// Same walk on the byte-class compressed table
+inline bool testDFA(const ByteClassDFA& dfa, const std::string& input) {
+    return runDFA(dfa, input).accepted;
+}
+
+// Strings advanced together by runBatch; enough independent table loads in
+// flight to cover memory latency without spilling the lane state
+constexpr size_t INTERLEAVE_LANES = 8;
+
+struct BatchOutcome {
+    // Final state, the state that decided the outcome, or DEAD when the
+    // input hit a missing transition
+    StateId state;
+    // Bytes consumed up to that state; for DEAD, the offset of the byte with
+    // no transition
+    size_t offset;
+};
+
+// Runs many strings through one table with INTERLEAVE_LANES of them in
+// lockstep. A single string is a chain of dependent loads; interleaving
+// independent chains lets the CPU overlap their latencies. Finished lanes
+// are refilled with the next string, so long and short inputs mix freely.
+inline void runBatch(const ByteClassDFA& dfa, const std::vector<const std::string*>& inputs,
+                     std::vector<BatchOutcome>& outcomes) {
+    struct Lane {
+        const unsigned char* begin;
+        const unsigned char* p;
+        const unsigned char* end;
+        StateId state;
+        size_t index;
+    };
+
+    outcomes.resize(inputs.size());
+    Lane lanes[INTERLEAVE_LANES];
+    size_t active = 0;
+    size_t next = 0;
+
+    auto load = [&](Lane& lane) {
+        const std::string& input = *inputs[next];
+        lane.begin = lane.p = reinterpret_cast<const unsigned char*>(input.data());
+        lane.end = lane.begin + input.size();
+        lane.state = dfa.start;
+        lane.index = next++;
+    };
+
+    while (active < INTERLEAVE_LANES && next < inputs.size()) {
+        load(lanes[active++]);
+    }
+
+    // Read through a local pointer so the check is not reloaded after every
+    // store to `outcomes`
+    const uint8_t* verdicts = dfa.verdicts.data();
+    auto open = [verdicts](StateId state) {
+        return static_cast<Verdict>(verdicts[static_cast<StateId>(state + 1)]) == Verdict::Open;
+    };
+
+    while (active > 0) {
+        for (size_t l = 0; l < active; l++) {
+            Lane& lane = lanes[l];
+            if (lane.p != lane.end && open(lane.state)) {
+                StateId stepped = dfa.step(lane.state, *lane.p);
+                // Stay on the offending byte when the step dies
+                lane.p += stepped != ByteClassDFA::DEAD;
+                lane.state = stepped;
+                continue;
+            }
+
+            if (lane.p != lane.end && dfa.verdict(lane.state) == Verdict::Accept) {
+                // Accept sink: a byte outside the alphabet is the only way to fail
+                const char* begin = reinterpret_cast<const char*>(lane.begin);
+                size_t unknown = dfa.findNonAlphabet(begin, lane.p - lane.begin, lane.end - lane.begin);
+                if (unknown < static_cast<size_t>(lane.end - lane.begin)) {
+                    lane.state = ByteClassDFA::DEAD;
+                    lane.p = lane.begin + unknown;
+                }
+            }
+
+            outcomes[lane.index] = {lane.state, static_cast<size_t>(lane.p - lane.begin)};
+            if (next < inputs.size()) {
+                load(lane);
+            } else {
+                lane = lanes[--active];
+                l--;
+            }
+        }
+    }
+}
+
+// Unknown symbols (NO_ID) and symbols outside the table use the DEAD column
+inline StateId stepSymbol(const DenseDFA& dfa, StateId state, SymbolId symbol) {
+    return dfa.next(state, symbol < dfa.numSymbols ? symbol : dfa.numSymbols);
+}
+
+// `tokenizer` must be built over the table's alphabet
+inline bool testDFA(const DenseDFA& dfa, const Tokenizer& tokenizer, const std::string& input) {
+    if (tokenizer.mode() == TokenMode::Byte) {
+        return testDFA(dfa, input);
+    }
+
+    StateId current = dfa.start;
+    SymbolId symbol;
+    for (size_t pos = 0; pos < input.size();) {
+        pos += tokenizer.next(input, pos, symbol);
+        current = stepSymbol(dfa, current, symbol);
+        if (current == DenseDFA::DEAD) {
+            return false;
+        }
+    }
+    return dfa.accepting[current] != 0;
+}
+
+// Pre-lexed input
+inline bool testDFA(const DenseDFA& dfa, const std::vector<SymbolId>& symbols) {
+    StateId current = dfa.start;
+
+    for (SymbolId symbol : symbols) {
+        current = stepSymbol(dfa, current, symbol);
+        if (current == DenseDFA::DEAD) {
+            return false;
+        }
+    }
+    return dfa.accepting[current] != 0;
+}
+
+// Early-exit runs on the dense table; `verdicts` comes from stateVerdicts(dfa).
+// After an accept sink the remaining symbols are only checked to be known.
+inline RunResult runDFA(const DenseDFA& dfa, const std::vector<uint8_t>& verdicts, const Tokenizer& tokenizer,
+                        const std::string& input) {
+    StateId current = dfa.start;
+    size_t read = 0;
+    size_t pos = 0;
+    SymbolId symbol;
+    while (pos < input.size() && verdictOf(verdicts, current) == Verdict::Open) {
+        pos += tokenizer.next(input, pos, symbol);
+        current = stepSymbol(dfa, current, symbol);
+        read++;
+    }
+
+    Verdict verdict = verdictOf(verdicts, current);
+    if (verdict == Verdict::Accept) {
+        for (size_t scanned = read; pos < input.size();) {
+            pos += tokenizer.next(input, pos, symbol);
+            scanned++;
+            if (symbol >= dfa.numSymbols) return {false, scanned};
+        }
+    }
+    return {verdict == Verdict::Open ? dfa.accepting[current] != 0 : verdict == Verdict::Accept, read};
+}
+
+inline RunResult runDFA(const DenseDFA& dfa, const std::vector<uint8_t>& verdicts, const std::vector<SymbolId>& symbols) {
+    StateId current = dfa.start;
+    size_t read = 0;
+    while (read < symbols.size() && verdictOf(verdicts, current) == Verdict::Open) {
+        current = stepSymbol(dfa, current, symbols[read++]);
+    }
+
+    Verdict verdict = verdictOf(verdicts, current);
+    if (verdict == Verdict::Accept) {
+        for (size_t i = read; i < symbols.size(); i++) {
+            if (symbols[i] >= dfa.numSymbols) return {false, i + 1};
+        }
+    }
+    return {verdict == Verdict::Open ? dfa.accepting[current] != 0 : verdict == Verdict::Accept, read};
+}
+
+} // namespace automata
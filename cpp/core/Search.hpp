@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ByteClasses.hpp"
+#include "Determinize.hpp"
+
+// Unanchored search: where in a text does the automaton's language occur.
+//
+// Match ends come from one forward pass of the unanchored DFA (see
+// determinize), which is in an accepting state after exactly those prefixes
+// that end with a match. Bytes outside the alphabet cannot be part of a
+// match, so they send the search back to its start state instead of DEAD.
+//
+// Leftmost-longest matches need starts as well. One backward pass of the
+// unanchored DFA of the reversed automaton marks every offset at which some
+// match begins; each reported match then takes the leftmost marked start at
+// or after the previous match and runs the anchored DFA from it for the
+// longest end. Those anchored runs stop as soon as no accepting state is
+// reachable, but a pattern whose attempts run long without matching can
+// make them quadratic in the worst case.
+
+namespace automata {
+
+struct Match {
+    size_t start;
+    size_t end;
+};
+
+// Automaton for the reversed language: every edge flipped, a fresh start
+// state with epsilon edges to the accepting states, and the old start state
+// as the only accepting one
+inline Automaton reverseAutomaton(const Automaton& fa) {
+    Automaton r;
+    r.states = fa.states;
+    r.symbols = fa.symbols;
+    r.declaredSymbols = fa.declaredSymbols;
+
+    std::string startName = "reverse-start";
+    while (r.states.find(startName) != NO_ID) {
+        startName += "'";
+    }
+    r.start = r.states.intern(startName);
+
+    const uint32_t n = r.numStates();
+    const uint32_t numSymbols = r.numSymbols();
+    r.accepting.assign(n, 0);
+    r.accepting[fa.start] = 1;
+    r.hasRow.assign(n, 1);
+
+    // Flipped symbol edges, bucketed by (target, symbol) row
+    r.offsets.assign(static_cast<size_t>(n) * numSymbols + 1, 0);
+    for (StateId s = 0; s < fa.numStates(); s++) {
+        for (SymbolId c = 0; c < numSymbols; c++) {
+            for (const StateId* t = fa.targetsBegin(s, c); t != fa.targetsEnd(s, c); ++t) {
+                r.offsets[r.row(*t, c) + 1]++;
+            }
+        }
+    }
+    for (size_t i = 1; i < r.offsets.size(); i++) {
+        r.offsets[i] += r.offsets[i - 1];
+    }
+    r.targets.resize(r.offsets.back());
+    std::vector<uint32_t> fill(r.offsets.begin(), r.offsets.end() - 1);
+    for (StateId s = 0; s < fa.numStates(); s++) {
+        for (SymbolId c = 0; c < numSymbols; c++) {
+            for (const StateId* t = fa.targetsBegin(s, c); t != fa.targetsEnd(s, c); ++t) {
+                r.targets[fill[r.row(*t, c)]++] = s;
+            }
+        }
+    }
+
+    // Flipped epsilon edges plus the new start's edges
+    std::vector<std::vector<StateId>> epsilon(n);
+    for (StateId s = 0; s < fa.numStates(); s++) {
+        for (const StateId* t = fa.epsilonBegin(s); t != fa.epsilonEnd(s); ++t) {
+            epsilon[*t].push_back(s);
+        }
+        if (fa.accepting[s]) {
+            epsilon[r.start].push_back(s);
+        }
+    }
+    r.epsOffsets.assign(n + 1, 0);
+    for (StateId s = 0; s < n; s++) {
+        r.epsOffsets[s + 1] = r.epsOffsets[s] + static_cast<uint32_t>(epsilon[s].size());
+        r.epsTargets.insert(r.epsTargets.end(), epsilon[s].begin(), epsilon[s].end());
+    }
+
+    indexByteSymbols(r);
+    return r;
+}
+
+// Byte table of the unanchored DFA; bytes outside the alphabet restart the search
+inline ByteClassDFA unanchoredTable(const Automaton& fa) {
+    DenseDFA dense = determinize(fa, true).table;
+    for (StateId& target : dense.table) {
+        if (target == DenseDFA::DEAD) {
+            target = dense.start;
+        }
+    }
+    return compressByteClasses(dense);
+}
+
+class Searcher {
+public:
+    // The reverse and anchored tables are only built with `recoverStarts`
+    Searcher(const Automaton& fa, bool recoverStarts) {
+        // Symbols that only appear as transition keys are searched for too
+        Automaton pattern = fa;
+        pattern.declaredSymbols = pattern.numSymbols();
+        for (const std::string& symbol : pattern.symbols.names) {
+            if (symbol.size() != 1) {
+                throw std::runtime_error("Search needs an alphabet of single-byte symbols, got '" + symbol + "'");
+            }
+        }
+
+        forward = unanchoredTable(pattern);
+        if (recoverStarts) {
+            reverse = unanchoredTable(reverseAutomaton(pattern));
+            anchored = compressByteClasses(determinize(pattern).table);
+        }
+    }
+
+    // Calls onEnd(offset) for every offset at which some match ends, in
+    // increasing order; offset 0 when the empty string matches
+    template <typename OnEnd>
+    void forEachEnd(const char* data, size_t size, OnEnd onEnd) const {
+        StateId state = forward.start;
+        // The table has no DEAD entries, so only an empty language rejects
+        if (forward.verdict(state) == Verdict::Reject) return;
+
+        if (forward.accepting[state]) onEnd(size_t(0));
+        for (size_t i = 0; i < size; i++) {
+            state = forward.step(state, static_cast<unsigned char>(data[i]));
+            if (forward.accepting[state]) onEnd(i + 1);
+        }
+    }
+
+    // Calls onMatch(Match) for the leftmost-longest, non-overlapping matches
+    // in order. An empty match is followed by a search one byte further on.
+    // Needs a Searcher built with recoverStarts.
+    template <typename OnMatch>
+    void forEachMatch(const char* data, size_t size, OnMatch onMatch) const {
+        if (reverse.numStates == 0) {
+            throw std::logic_error("Searcher was built without start recovery");
+        }
+
+        // starts[i]: some match begins at offset i
+        std::vector<uint8_t> starts(size + 1);
+        StateId state = reverse.start;
+        starts[size] = reverse.accepting[state];
+        for (size_t i = size; i-- > 0;) {
+            state = reverse.step(state, static_cast<unsigned char>(data[i]));
+            starts[i] = reverse.accepting[state];
+        }
+
+        size_t pos = 0;
+        while (pos <= size) {
+            size_t start = static_cast<size_t>(std::find(starts.begin() + pos, starts.end(), 1) - starts.begin());
+            if (start > size) break;
+            size_t end = longestEnd(data, size, start);
+            onMatch(Match{start, end});
+            pos = end > start ? end : start + 1;
+        }
+    }
+
+private:
+    // End of the longest match starting at `start`, which must begin one
+    size_t longestEnd(const char* data, size_t size, size_t start) const {
+        StateId state = anchored.start;
+        size_t end = start;
+        for (size_t i = start; i < size; i++) {
+            Verdict verdict = anchored.verdict(state);
+            if (verdict == Verdict::Reject) break;
+            if (verdict == Verdict::Accept) {
+                // Every further alphabet byte extends the match
+                return anchored.findNonAlphabet(data, i, size);
+            }
+            state = anchored.step(state, static_cast<unsigned char>(data[i]));
+            if (state != ByteClassDFA::DEAD && anchored.accepting[state]) {
+                end = i + 1;
+            }
+        }
+        return end;
+    }
+
+    ByteClassDFA forward;
+    ByteClassDFA reverse;
+    ByteClassDFA anchored;
+};
+
+} // namespace automata
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <exception>
+#include <iostream>
+#include <string>
+#include "../libraries/json.hpp"
+
+// Long-lived worker mode shared by the tools (`<tool> --serve`).
+//
+// Each stdin line is one JSON request and produces exactly one JSON line on
+// stdout, flushed immediately, so a parent process can keep the worker warm
+// and pipeline requests through it. An "id" field on the request is echoed
+// back on the response. Errors become {"success": false, "error": ...}
+// responses; the loop only ends at EOF.
+
+namespace automata {
+
+inline bool isServeMode(int argc, char* argv[]) {
+    return argc > 1 && std::string(argv[1]) == "--serve";
+}
+
+template <typename Handler>
+int serveLines(Handler handle) {
+    std::ios::sync_with_stdio(false);
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        nlohmann::json response;
+        nlohmann::json id;
+        try {
+            nlohmann::json request = nlohmann::json::parse(line);
+            if (request.is_object() && request.contains("id")) {
+                id = request["id"];
+            }
+            response = handle(request);
+        } catch (const std::exception& e) {
+            response = {
+                {"success", false},
+                {"error", e.what()}
+            };
+        }
+
+        if (!id.is_null()) {
+            response["id"] = id;
+        }
+        std::cout << response.dump() << '\n';
+        std::cout.flush();
+    }
+    return 0;
+}
+
+} // namespace automata
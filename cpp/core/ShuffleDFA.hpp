@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "ByteClasses.hpp"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define AUTOMATA_SHUFFLE_SIMD 1
+#endif
+
+// Kernel for DFAs with at most 16 states (counting the dead state).
+//
+// The transition function of one input byte is a 16-byte vector T with
+// T[s] = next state, so a vector holding the current state of 16 lanes is
+// advanced by one pshufb: lanes = shuffle(T[byte], lanes). Starting the
+// lanes at 0..15 runs the DFA from every state at once, which yields a
+// chunk's whole state-to-state function for the price of a single run, and
+// the only dependency chain is one 1-cycle shuffle per byte.
+//
+// The SIMD path needs SSSE3 at compile time (-mssse3 or -march=native with
+// GCC/Clang, /arch:AVX with MSVC); otherwise a scalar loop over the same
+// 4 KiB byte table is used.
+
+namespace automata {
+
+struct ShuffleDFA {
+    static constexpr uint32_t MAX_STATES = 16;
+
+    uint32_t numStates = 0;
+    // Lane value standing for DEAD; equals MAX_STATES when DEAD is unreachable
+    uint8_t dead = MAX_STATES;
+    // Byte -> next state of every state
+    alignas(16) uint8_t table[256][MAX_STATES];
+    // Lanes that can no longer accept (the dead lane included)
+    uint8_t rejected[MAX_STATES + 1];
+
+    uint8_t toLane(StateId state) const {
+        return state == ByteClassDFA::DEAD ? dead : static_cast<uint8_t>(state);
+    }
+
+    StateId fromLane(uint8_t lane) const {
+        return lane == dead ? ByteClassDFA::DEAD : lane;
+    }
+};
+
+// Fills `out` and returns true when the DFA fits in 16 lanes
+inline bool buildShuffleDFA(const ByteClassDFA& dfa, ShuffleDFA& out) {
+    bool hasDead = std::find(dfa.table.begin(), dfa.table.end(), ByteClassDFA::DEAD) != dfa.table.end();
+    if (dfa.numStates + (hasDead ? 1 : 0) > ShuffleDFA::MAX_STATES) {
+        return false;
+    }
+
+    out.numStates = dfa.numStates;
+    out.dead = hasDead ? static_cast<uint8_t>(dfa.numStates) : static_cast<uint8_t>(ShuffleDFA::MAX_STATES);
+    for (int b = 0; b < 256; b++) {
+        // Unused lanes (and the dead lane) stay where they are
+        for (uint32_t s = 0; s < ShuffleDFA::MAX_STATES; s++) {
+            out.table[b][s] = static_cast<uint8_t>(s);
+        }
+        for (StateId s = 0; s < dfa.numStates; s++) {
+            out.table[b][s] = out.toLane(dfa.step(s, static_cast<unsigned char>(b)));
+        }
+    }
+    for (uint32_t lane = 0; lane <= ShuffleDFA::MAX_STATES; lane++) {
+        out.rejected[lane] = lane >= dfa.numStates || dfa.verdict(lane) == Verdict::Reject;
+    }
+    return true;
+}
+
+#ifdef AUTOMATA_SHUFFLE_SIMD
+// Advances all 16 lanes over `data`
+inline void shuffleLanes(const ShuffleDFA& dfa, uint8_t lanes[ShuffleDFA::MAX_STATES], const char* data, size_t size) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        v = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(dfa.table[static_cast<unsigned char>(data[i])])), v);
+        v = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(dfa.table[static_cast<unsigned char>(data[i + 1])])), v);
+        v = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(dfa.table[static_cast<unsigned char>(data[i + 2])])), v);
+        v = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(dfa.table[static_cast<unsigned char>(data[i + 3])])), v);
+    }
+    for (; i < size; i++) {
+        v = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(dfa.table[static_cast<unsigned char>(data[i])])), v);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+}
+#endif
+
+// State after running `data` from `state`. Stops early once no accepting
+// state is reachable, checked once per block so the inner loop stays branch
+// free; such states only lead to each other, so overshooting is harmless.
+inline StateId runShuffle(const ShuffleDFA& dfa, StateId state, const char* data, size_t size) {
+    const size_t block = 4096;
+    uint8_t lane = dfa.toLane(state);
+
+#ifdef AUTOMATA_SHUFFLE_SIMD
+    alignas(16) uint8_t lanes[ShuffleDFA::MAX_STATES];
+    for (size_t pos = 0; pos < size && !dfa.rejected[lane]; pos += block) {
+        std::memset(lanes, lane, sizeof(lanes));
+        shuffleLanes(dfa, lanes, data + pos, std::min(block, size - pos));
+        lane = lanes[0];
+    }
+#else
+    for (size_t pos = 0; pos < size && !dfa.rejected[lane]; pos += block) {
+        size_t end = std::min(size, pos + block);
+        for (size_t i = pos; i < end; i++) {
+            lane = dfa.table[static_cast<unsigned char>(data[i])][lane];
+        }
+    }
+#endif
+
+    return dfa.fromLane(lane);
+}
+
+// Chunk function for the parallel runner: end state for every start state.
+// Returns false when the SIMD kernel is not compiled in.
+inline bool shuffleChunkFunction(const ShuffleDFA& dfa, const char* data, size_t size, std::vector<StateId>& mapping) {
+#ifdef AUTOMATA_SHUFFLE_SIMD
+    alignas(16) uint8_t lanes[ShuffleDFA::MAX_STATES];
+    for (uint32_t s = 0; s < ShuffleDFA::MAX_STATES; s++) {
+        lanes[s] = static_cast<uint8_t>(s);
+    }
+    shuffleLanes(dfa, lanes, data, size);
+
+    mapping.resize(dfa.numStates);
+    for (StateId s = 0; s < dfa.numStates; s++) {
+        mapping[s] = dfa.fromLane(lanes[s]);
+    }
+    return true;
+#else
+    (void)dfa;
+    (void)data;
+    (void)size;
+    (void)mapping;
+    return false;
+#endif
+}
+
+} // namespace automata
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Automaton.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Word-packed set of state IDs for NFA simulation and subset construction.
+//
+// A set over an n-state automaton is ceil(n / 64) machine words, so union is
+// a loop of ORs, equality is a word compare and hashing never looks at
+// individual states. All sets combined with each other must share a size.
+
+namespace automata {
+
+inline uint32_t popcount64(uint64_t word) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<uint32_t>(__popcnt64(word));
+#else
+    return static_cast<uint32_t>(__builtin_popcountll(word));
+#endif
+}
+
+inline uint32_t lowestBit64(uint64_t word) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(word));
+#endif
+}
+
+class StateSet {
+public:
+    StateSet() = default;
+    explicit StateSet(uint32_t size) : size_(size), words_((size + 63) / 64, 0) {}
+
+    uint32_t size() const { return size_; }
+    const std::vector<uint64_t>& words() const { return words_; }
+
+    bool contains(StateId s) const {
+        return (words_[s >> 6] >> (s & 63)) & 1;
+    }
+
+    void insert(StateId s) {
+        words_[s >> 6] |= uint64_t(1) << (s & 63);
+    }
+
+    // Returns true if `s` was not already present
+    bool insertNew(StateId s) {
+        uint64_t& word = words_[s >> 6];
+        uint64_t bit = uint64_t(1) << (s & 63);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+        return true;
+    }
+
+    void erase(StateId s) {
+        words_[s >> 6] &= ~(uint64_t(1) << (s & 63));
+    }
+
+    void clear() {
+        std::fill(words_.begin(), words_.end(), 0);
+    }
+
+    bool empty() const {
+        for (uint64_t word : words_) {
+            if (word) return false;
+        }
+        return true;
+    }
+
+    uint32_t count() const {
+        uint32_t total = 0;
+        for (uint64_t word : words_) {
+            total += popcount64(word);
+        }
+        return total;
+    }
+
+    StateSet& operator|=(const StateSet& other) {
+        for (size_t i = 0; i < words_.size(); i++) {
+            words_[i] |= other.words_[i];
+        }
+        return *this;
+    }
+
+    StateSet& operator&=(const StateSet& other) {
+        for (size_t i = 0; i < words_.size(); i++) {
+            words_[i] &= other.words_[i];
+        }
+        return *this;
+    }
+
+    bool intersects(const StateSet& other) const {
+        for (size_t i = 0; i < words_.size(); i++) {
+            if (words_[i] & other.words_[i]) return true;
+        }
+        return false;
+    }
+
+    bool isSubsetOf(const StateSet& other) const {
+        for (size_t i = 0; i < words_.size(); i++) {
+            if (words_[i] & ~other.words_[i]) return false;
+        }
+        return true;
+    }
+
+    bool operator==(const StateSet& other) const { return words_ == other.words_; }
+    bool operator!=(const StateSet& other) const { return words_ != other.words_; }
+
+    // Smallest member, NO_ID when empty
+    StateId first() const {
+        for (size_t i = 0; i < words_.size(); i++) {
+            if (words_[i]) {
+                return static_cast<StateId>(i * 64 + lowestBit64(words_[i]));
+            }
+        }
+        return NO_ID;
+    }
+
+    // Calls fn(state) for every member in increasing order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < words_.size(); i++) {
+            uint64_t word = words_[i];
+            while (word) {
+                fn(static_cast<StateId>(i * 64 + lowestBit64(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    size_t hash() const {
+        // FNV-1a over words, folded with a multiplicative mix per word
+        uint64_t h = 1469598103934665603ULL;
+        for (uint64_t word : words_) {
+            h ^= word * 0x9E3779B97F4A7C15ULL;
+            h *= 1099511628211ULL;
+        }
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+private:
+    uint32_t size_ = 0;
+    std::vector<uint64_t> words_;
+};
+
+struct StateSetHash {
+    size_t operator()(const StateSet& set) const { return set.hash(); }
+};
+
+inline StateSet acceptingSet(const Automaton& fa) {
+    StateSet accepting(fa.numStates());
+    for (StateId s = 0; s < fa.numStates(); s++) {
+        if (fa.accepting[s]) accepting.insert(s);
+    }
+    return accepting;
+}
+
+} // namespace automata
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ByteClasses.hpp"
+#include "DenseDFA.hpp"
+#include "MappedFile.hpp"
+#include "ParallelRunner.hpp"
+#include "Runner.hpp"
+#include "ShuffleDFA.hpp"
+#include "Tokenizer.hpp"
+
+// Incremental DFA execution over input that arrives in chunks.
+//
+// The current state is carried across feed() calls, so inputs far larger
+// than memory can be classified in one pass. In byte mode each chunk is
+// stepped in place on the byte-class table, or with the shuffle kernel of
+// core/ShuffleDFA.hpp for DFAs of up to 16 states. In the other tokenizer
+// modes the tail of a chunk that could still be the prefix of a longer token
+// is held back until more input (or EOF) decides it. runFile() feeds a whole
+// memory-mapped file as a single chunk.
+
+namespace automata {
+
+class StreamRunner {
+public:
+    StreamRunner(const DenseDFA& dfa, const Tokenizer& tokenizer)
+        : dfa(dfa), tokenizer(tokenizer), current(dfa.start) {
+        if (tokenizer.mode() == TokenMode::Byte) {
+            byteClasses = compressByteClasses(dfa);
+            verdicts = byteClasses.verdicts;
+            shuffle.reset(new ShuffleDFA());
+            if (!buildShuffleDFA(byteClasses, *shuffle)) {
+                shuffle.reset();
+            }
+        } else {
+            verdicts = stateVerdicts(dfa);
+        }
+    }
+
+    // With threads > 1, large chunks in byte mode are split across threads
+    // (see core/ParallelRunner.hpp)
+    void feed(const char* data, size_t length, unsigned threads = 1) {
+        if (dead()) return;
+        consumed += length;
+
+        if (tokenizer.mode() == TokenMode::Byte && threads > 1) {
+            current = runParallel(byteClasses, current, data, length, threads);
+            return;
+        }
+
+        if (shuffle) {
+            current = runShuffle(*shuffle, current, data, length);
+            return;
+        }
+
+        if (tokenizer.mode() == TokenMode::Byte) {
+            size_t i = 0;
+            while (i < length && byteClasses.verdict(current) == Verdict::Open) {
+                current = byteClasses.step(current, static_cast<unsigned char>(data[i++]));
+            }
+            // Past an accept sink only bytes outside the alphabet matter
+            if (byteClasses.verdict(current) == Verdict::Accept &&
+                byteClasses.findNonAlphabet(data, i, length) < length) {
+                current = DenseDFA::DEAD;
+            }
+            return;
+        }
+
+        // Large chunks (e.g. a whole mapped file) are scanned in place and
+        // only their undecided tail is buffered
+        if (pending.empty()) {
+            size_t used = drain(data, length, tokenizer.maxTokenLength());
+            if (!dead()) {
+                pending.assign(data + used, length - used);
+            }
+            return;
+        }
+
+        pending.append(data, length);
+        pending.erase(0, drain(pending.data(), pending.size(), tokenizer.maxTokenLength()));
+    }
+
+    // Call at EOF; returns whether the whole input was accepted
+    bool finish() {
+        if (!dead()) {
+            drain(pending.data(), pending.size(), 1);
+            pending.clear();
+        }
+        return !dead() && dfa.accepting[current] != 0;
+    }
+
+    // No continuation can be accepted any more (see core/Liveness.hpp);
+    // callers may stop reading
+    bool dead() const { return verdictOf(verdicts, current) == Verdict::Reject; }
+
+    size_t bytesConsumed() const { return consumed; }
+
+private:
+    // Steps over every token that has at least `lookahead` bytes after its
+    // start (or all of them when lookahead is 1); returns the bytes used
+    size_t drain(const char* data, size_t size, size_t lookahead) {
+        size_t pos = 0;
+        SymbolId symbol;
+        while (pos < size && size - pos >= lookahead) {
+            pos += tokenizer.next(data, size, pos, symbol);
+            current = stepSymbol(dfa, current, symbol);
+            if (dead()) break;
+        }
+        return pos;
+    }
+
+    const DenseDFA& dfa;
+    const Tokenizer& tokenizer;
+    ByteClassDFA byteClasses;
+    // Set when the byte-mode DFA fits the 16-lane shuffle kernel
+    std::unique_ptr<ShuffleDFA> shuffle;
+    // Verdict per state + 1 of the table being stepped
+    std::vector<uint8_t> verdicts;
+    StateId current;
+    std::string pending;
+    size_t consumed = 0;
+};
+
+// Reads `in` to EOF in fixed-size chunks, stopping early once no accepting
+// state is reachable
+inline bool runStream(StreamRunner& runner, std::FILE* in, size_t chunkSize = 1 << 20) {
+    std::vector<char> buffer(chunkSize);
+    size_t n;
+    while (!runner.dead() && (n = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+        runner.feed(buffer.data(), n);
+    }
+    if (std::ferror(in)) {
+        throw std::runtime_error("Error reading input stream");
+    }
+    return runner.finish();
+}
+
+// Scans a file through a read-only mapping, or in chunks when it cannot be
+// mapped (pipes, special files). A mapped file can be split across threads.
+inline bool runFile(StreamRunner& runner, const std::string& path, unsigned threads = 1) {
+    MappedFile mapped(path);
+    if (mapped.isOpen()) {
+        runner.feed(mapped.data(), mapped.size(), threads);
+        return runner.finish();
+    }
+
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    bool accepted = runStream(runner, in);
+    std::fclose(in);
+    return accepted;
+}
+
+} // namespace automata
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Automaton.hpp"
+
+// Splits input strings into symbol IDs before they reach an engine.
+//
+//   byte   every byte is one symbol (single-character alphabets)
+//   utf8   every UTF-8 codepoint is one symbol
+//   token  longest symbol that matches at the current position, so
+//          alphabets may contain whole words such as "if" or "=="
+//
+// "auto" picks the narrowest mode that covers the alphabet. Text that is not
+// a symbol still produces one token (a byte in byte mode, a codepoint
+// otherwise) with the NO_ID symbol, so engines can reject it.
+
+namespace automata {
+
+enum class TokenMode { Byte, Codepoint, LongestMatch };
+
+// Length of the UTF-8 sequence introduced by `lead`; stray continuation and
+// invalid bytes count as one byte so malformed input still advances
+inline size_t utf8Length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+inline bool isSingleCodepoint(const std::string& s) {
+    return !s.empty() && utf8Length(static_cast<unsigned char>(s[0])) == s.size();
+}
+
+inline TokenMode tokenModeFor(const std::vector<std::string>& symbols) {
+    TokenMode mode = TokenMode::Byte;
+    for (const std::string& symbol : symbols) {
+        if (symbol.size() == 1) continue;
+        if (!isSingleCodepoint(symbol)) return TokenMode::LongestMatch;
+        mode = TokenMode::Codepoint;
+    }
+    return mode;
+}
+
+inline TokenMode parseTokenMode(const std::string& name, const std::vector<std::string>& symbols) {
+    if (name == "auto") return tokenModeFor(symbols);
+    if (name == "byte") return TokenMode::Byte;
+    if (name == "utf8") return TokenMode::Codepoint;
+    if (name == "token") return TokenMode::LongestMatch;
+    throw std::runtime_error("Unknown tokenize mode '" + name + "' (expected auto, byte, utf8 or token)");
+}
+
+class Tokenizer {
+public:
+    // `symbols[id]` is the text of symbol `id`
+    Tokenizer(const std::vector<std::string>& symbols, TokenMode mode)
+        : tokenMode(mode), trie(1) {
+        byteSymbol.fill(NO_ID);
+        for (SymbolId id = 0; id < symbols.size(); id++) {
+            const std::string& symbol = symbols[id];
+            if (symbol.empty()) continue;
+            ids.emplace(symbol, id);
+            longestSymbol = std::max(longestSymbol, symbol.size());
+            if (symbol.size() == 1) {
+                byteSymbol[static_cast<unsigned char>(symbol[0])] = id;
+            }
+            if (mode == TokenMode::LongestMatch) {
+                insertToken(symbol, id);
+            }
+        }
+    }
+
+    Tokenizer(const std::vector<std::string>& symbols, const std::string& modeName)
+        : Tokenizer(symbols, parseTokenMode(modeName, symbols)) {}
+
+    TokenMode mode() const { return tokenMode; }
+
+    // Bytes of lookahead next() may need to decide on a token
+    size_t maxTokenLength() const {
+        if (tokenMode == TokenMode::Byte) return 1;
+        return std::max<size_t>(4, longestSymbol);
+    }
+
+    // Reads the token starting at `pos` and returns its length in bytes
+    size_t next(const std::string& input, size_t pos, SymbolId& symbol) const {
+        return next(input.data(), input.size(), pos, symbol);
+    }
+
+    size_t next(const char* input, size_t size, size_t pos, SymbolId& symbol) const {
+        unsigned char lead = static_cast<unsigned char>(input[pos]);
+
+        if (tokenMode == TokenMode::Byte) {
+            symbol = byteSymbol[lead];
+            return 1;
+        }
+
+        size_t codepoint = std::min(utf8Length(lead), size - pos);
+
+        if (tokenMode == TokenMode::Codepoint) {
+            symbol = codepoint == 1 ? byteSymbol[lead] : find(std::string(input + pos, codepoint));
+            return codepoint;
+        }
+
+        // Longest match: walk the trie as far as the input allows and keep
+        // the last node that ends a symbol
+        symbol = NO_ID;
+        size_t length = codepoint;
+        uint32_t node = 0;
+        for (size_t i = pos; i < size; i++) {
+            node = child(node, static_cast<unsigned char>(input[i]));
+            if (node == NO_ID) break;
+            if (trie[node].symbol != NO_ID) {
+                symbol = trie[node].symbol;
+                length = i - pos + 1;
+            }
+        }
+        return length;
+    }
+
+    // Symbol of an already separated token, e.g. an element of a pre-lexed input
+    SymbolId find(const std::string& token) const {
+        auto it = ids.find(token);
+        return it == ids.end() ? NO_ID : it->second;
+    }
+
+    // Calls f(symbol, begin, length) for every token of `input`
+    template <typename F>
+    void forEach(const std::string& input, F f) const {
+        SymbolId symbol;
+        for (size_t pos = 0; pos < input.size();) {
+            size_t length = next(input, pos, symbol);
+            f(symbol, pos, length);
+            pos += length;
+        }
+    }
+
+private:
+    struct TrieNode {
+        std::vector<std::pair<unsigned char, uint32_t>> children;
+        SymbolId symbol = NO_ID;
+    };
+
+    uint32_t child(uint32_t node, unsigned char byte) const {
+        for (const auto& [b, next] : trie[node].children) {
+            if (b == byte) return next;
+        }
+        return NO_ID;
+    }
+
+    void insertToken(const std::string& token, SymbolId id) {
+        uint32_t node = 0;
+        for (char c : token) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            uint32_t next = child(node, byte);
+            if (next == NO_ID) {
+                next = static_cast<uint32_t>(trie.size());
+                trie[node].children.push_back({byte, next});
+                trie.emplace_back();
+            }
+            node = next;
+        }
+        trie[node].symbol = id;
+    }
+
+    TokenMode tokenMode;
+    size_t longestSymbol = 0;
+    std::array<SymbolId, 256> byteSymbol;
+    std::unordered_map<std::string, SymbolId> ids;
+    std::vector<TrieNode> trie;
+};
+
+} // namespace automata
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "Automaton.hpp"
+#include "Determinize.hpp"
+#include "EpsilonClosure.hpp"
+#include "StateSet.hpp"
+#include "Tokenizer.hpp"
+
+// Reconstructs an actual run of an NFA on an input.
+//
+// A forward pass simulates the state sets and keeps only a checkpoint of
+// the set every k = ceil(sqrt(n)) symbols, plus the input as symbol IDs. The
+// run is then rebuilt backwards one segment at a time: the sets of the last
+// segment are simulated again from its checkpoint, and each state is traced
+// to a predecessor in the previous set by the symbol read and a breadth-first
+// search over epsilon edges within the step. The walk starts from an
+// accepting state of the final set (or, on rejection, from the last set that
+// still had states). Memory is O(n) symbol IDs plus O(sqrt(n)) state sets of
+// |Q| bits, instead of a back-pointer for every state of every set, at the
+// cost of simulating the input twice. StringValidator's plain accept/reject
+// path does none of this.
+
+namespace automata {
+
+struct TraceStep {
+    StateId state;
+    // NO_ID for the start state; epsilon steps have epsilon = true
+    SymbolId symbol;
+    bool epsilon;
+};
+
+struct RunTrace {
+    bool accepted = false;
+    // False when the run stopped at a missing transition before the end
+    bool complete = true;
+    std::vector<TraceStep> steps;
+};
+
+class RunTracer {
+public:
+    RunTracer(const Automaton& fa, TokenMode mode)
+        : fa(fa), tokenizer(fa.symbols.names, mode), closure(fa), moved(fa.numStates()),
+          parent(fa.numStates()), stamp(fa.numStates(), NO_ID) {}
+
+    RunTrace traceString(const std::string& inputString) {
+        symbols.clear();
+        SymbolId symbol;
+        for (size_t pos = 0; pos < inputString.size();) {
+            pos += tokenizer.next(inputString, pos, symbol);
+            symbols.push_back(symbol);
+        }
+        return run();
+    }
+
+    RunTrace traceTokens(const std::vector<std::string>& tokens) {
+        symbols.clear();
+        for (const std::string& token : tokens) {
+            symbols.push_back(tokenizer.find(token));
+        }
+        return run();
+    }
+
+private:
+    // next = closure(move(current, symbol)); empty for an unknown symbol
+    void step(const StateSet& current, SymbolId symbol, StateSet& next) {
+        next.clear();
+        if (symbol == NO_ID) return;
+        move(current, symbol, fa, moved);
+        closure.close(moved, next);
+    }
+
+    // Breadth-first search over epsilon edges from `sources` to `target`.
+    // Appends target and the states before it back to the source reached
+    // first, all but that source as epsilon steps, and returns the source.
+    StateId walkBack(const StateSet& sources, StateId target, std::vector<TraceStep>& reversed) {
+        if (++searches == NO_ID) {
+            std::fill(stamp.begin(), stamp.end(), NO_ID);
+            searches = 0;
+        }
+        queue.clear();
+        sources.forEach([&](StateId state) {
+            stamp[state] = searches;
+            parent[state] = NO_ID;
+            queue.push_back(state);
+        });
+        for (size_t head = 0; head < queue.size() && stamp[target] != searches; head++) {
+            StateId state = queue[head];
+            for (const StateId* t = fa.epsilonBegin(state); t != fa.epsilonEnd(state); ++t) {
+                if (stamp[*t] != searches) {
+                    stamp[*t] = searches;
+                    parent[*t] = state;
+                    queue.push_back(*t);
+                }
+            }
+        }
+
+        StateId state = target;
+        for (; parent[state] != NO_ID; state = parent[state]) {
+            reversed.push_back({state, NO_ID, true});
+        }
+        return state;
+    }
+
+    RunTrace run() {
+        const size_t n = symbols.size();
+        size_t interval = 1;
+        while (interval * interval < n) interval++;
+
+        // Forward: S_0 .. S_reached, checkpointing S_i for i = 0, k, 2k, ...
+        RunTrace trace;
+        checkpoints.clear();
+        StateSet current(fa.numStates());
+        StateSet next(fa.numStates());
+        closure.closeState(fa.start, current);
+        size_t reached = 0;
+        for (;; reached++) {
+            if (reached % interval == 0) {
+                checkpoints.push_back(current);
+            }
+            if (reached == n) break;
+            step(current, symbols[reached], next);
+            if (next.empty()) {
+                trace.complete = false;
+                break;
+            }
+            std::swap(current, next);
+        }
+
+        StateId state = current.first();
+        if (trace.complete) {
+            StateSet accepting = acceptingSet(fa);
+            accepting &= current;
+            if (!accepting.empty()) {
+                state = accepting.first();
+                trace.accepted = true;
+            }
+        }
+
+        // Backward, one segment per checkpoint, from the last one at or before `reached`
+        std::vector<TraceStep> reversed;
+        std::vector<StateSet> segment;
+        size_t end = reached;
+        for (size_t c = checkpoints.size(); c-- > 0;) {
+            size_t base = c * interval;
+            segment.resize(end - base + 1, StateSet(fa.numStates()));
+            segment[0] = checkpoints[c];
+            for (size_t i = base; i < end; i++) {
+                step(segment[i - base], symbols[i], segment[i - base + 1]);
+            }
+
+            for (size_t i = end; i > base; i--) {
+                // The state was reached from `moved` by epsilon edges, and one
+                // of `moved` from the previous set by the symbol
+                const StateSet& previous = segment[i - 1 - base];
+                SymbolId symbol = symbols[i - 1];
+                move(previous, symbol, fa, moved);
+                StateId source = walkBack(moved, state, reversed);
+                reversed.push_back({source, symbol, false});
+
+                state = NO_ID;
+                previous.forEach([&](StateId candidate) {
+                    if (state != NO_ID) return;
+                    for (const StateId* t = fa.targetsBegin(candidate, symbol); t != fa.targetsEnd(candidate, symbol); ++t) {
+                        if (*t == source) {
+                            state = candidate;
+                            break;
+                        }
+                    }
+                });
+            }
+            end = base;
+        }
+
+        moved.clear();
+        moved.insert(fa.start);
+        walkBack(moved, state, reversed);
+        reversed.push_back({fa.start, NO_ID, false});
+
+        trace.steps.assign(reversed.rbegin(), reversed.rend());
+        return trace;
+    }
+
+    const Automaton& fa;
+    Tokenizer tokenizer;
+    EpsilonClosure closure;
+    std::vector<SymbolId> symbols;
+    std::vector<StateSet> checkpoints;
+    StateSet moved;
+    // Epsilon search: predecessor of each state, the search that last saw
+    // it, and the queue
+    std::vector<StateId> parent;
+    std::vector<uint32_t> stamp;
+    uint32_t searches = 0;
+    std::vector<StateId> queue;
+};
+
+} // namespace automata
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "EpsilonClosure.hpp"
+#include "LazyDFA.hpp"
+#include "Liveness.hpp"
+#include "Tokenizer.hpp"
+
+// Set-based NFA simulation used by StringValidator and `automata validate`.
+
+namespace automata {
+
+struct ValidationResult {
+    bool accepted;
+    std::vector<std::string> path;
+    std::string currentState;
+    int position;
+    std::string error;
+    // Symbols read when the outcome became certain (core/Liveness.hpp),
+    // counting one with no transition
+    int decidedAt = 0;
+};
+
+// Token text for messages; a lone non-ASCII byte (byte mode splitting a
+// UTF-8 sequence) is not valid UTF-8 on its own, so it is shown as \xNN
+inline std::string displayToken(const std::string& text) {
+    if (text.size() == 1 && static_cast<unsigned char>(text[0]) >= 0x80) {
+        static const char hex[] = "0123456789ABCDEF";
+        unsigned char byte = static_cast<unsigned char>(text[0]);
+        return std::string("\\x") + hex[byte >> 4] + hex[byte & 0xF];
+    }
+    return text;
+}
+
+// A state set is reported by its lexicographically smallest name, as when
+// the simulation kept a std::set<std::string>. Only the result being built
+// pays for the comparisons.
+inline const std::string& smallestName(const Automaton& fa, const StateSet& states) {
+    const std::string* smallest = nullptr;
+    states.forEach([&](StateId state) {
+        const std::string& name = fa.states.name(state);
+        if (!smallest || name < *smallest) {
+            smallest = &name;
+        }
+    });
+    return *smallest;
+}
+
+// Validates any number of strings against one compiled automaton. The
+// closure table and all state sets are built once and reused per string.
+class StringValidator {
+public:
+    StringValidator(const Automaton& fa, TokenMode mode)
+        : fa(fa), tokenizer(fa.symbols.names, mode), closure(fa), currentStates(fa.numStates()), nextStates(fa.numStates()),
+          scratch(fa.numStates()), accepting(acceptingSet(fa)), live(liveStates(fa)), sinks(acceptSinks(fa)) {}
+
+    explicit StringValidator(const Automaton& fa)
+        : StringValidator(fa, tokenModeFor(fa.symbols.names)) {}
+
+    ValidationResult validateString(const std::string& inputString, bool trackPath = true) {
+        size_t pos = 0;
+        return simulate([&](SymbolId& symbol, std::string& text) {
+            if (pos >= inputString.size()) return false;
+            size_t length = tokenizer.next(inputString, pos, symbol);
+            text.assign(inputString, pos, length);
+            pos += length;
+            return true;
+        }, trackPath);
+    }
+
+    // Pre-lexed input: every element is one symbol
+    ValidationResult validateTokens(const std::vector<std::string>& tokens, bool trackPath = true) {
+        size_t i = 0;
+        return simulate([&](SymbolId& symbol, std::string& text) {
+            if (i >= tokens.size()) return false;
+            text = tokens[i++];
+            symbol = tokenizer.find(text);
+            return true;
+        }, trackPath);
+    }
+
+private:
+    bool decided(const StateSet& states) const {
+        return !states.intersects(live) || states.intersects(sinks);
+    }
+
+    // nextToken(symbol, text) yields the input one symbol at a time and
+    // returns false at the end. The result is fixed once the outcome is
+    // decided: a state set that can no longer accept stops the run, and past
+    // an accept sink the rest is only checked for symbols outside the
+    // alphabet. With trackPath the walk goes on to record the path, but
+    // everything else is the same as without.
+    template <typename NextToken>
+    ValidationResult simulate(NextToken nextToken, bool trackPath) {
+        ValidationResult result;
+        result.accepted = false;
+        result.position = 0;
+        result.decidedAt = -1;
+
+        // Accepted, and the state to report, for the current set
+        auto settle = [&]() {
+            result.decidedAt = result.position;
+            scratch = currentStates;
+            scratch &= accepting;
+            result.accepted = !scratch.empty();
+            if (result.accepted) {
+                result.currentState = smallestName(fa, scratch);
+            } else if (result.position > 0) {
+                result.currentState = smallestName(fa, currentStates);
+            }
+        };
+
+        try {
+            // Start with epsilon closure of the start state
+            currentStates.clear();
+            closure.closeState(fa.start, currentStates);
+
+            // Add all states in initial epsilon closure to path
+            if (trackPath) {
+                result.path.push_back(fa.states.name(fa.start));
+                std::vector<std::string> reached;
+                currentStates.forEach([&](StateId state) {
+                    if (state != fa.start) {
+                        reached.push_back(fa.states.name(state));
+                    }
+                });
+                std::sort(reached.begin(), reached.end());
+                for (const std::string& name : reached) {
+                    result.path.push_back(name + " (ɛ)");
+                }
+            }
+
+            if (decided(currentStates)) {
+                settle();
+            }
+
+            // Process each input symbol
+            SymbolId symbol;
+            std::string text;
+            while ((trackPath || result.decidedAt < 0) && nextToken(symbol, text)) {
+                nextStates.clear();
+
+                // For each current state, find all possible next states
+                if (symbol != NO_ID) {
+                    currentStates.forEach([&](StateId currentState) {
+                        for (const StateId* next = fa.targetsBegin(currentState, symbol); next != fa.targetsEnd(currentState, symbol); ++next) {
+                            nextStates.insert(*next);
+                        }
+                    });
+                }
+
+                // If no transitions found for this symbol, reject. Once
+                // rejection is decided only the path ends here, and past an
+                // accept sink only an unknown symbol gets here.
+                if (nextStates.empty()) {
+                    if (result.decidedAt < 0 || result.accepted) {
+                        if (result.decidedAt < 0 && result.position > 0) {
+                            result.currentState = smallestName(fa, currentStates);
+                        }
+                        result.error = "No valid transition for symbol '" + displayToken(text) + "' from current states";
+                        result.accepted = false;
+                        result.decidedAt = result.position + 1;
+                    }
+                    return result;
+                }
+
+                // Add epsilon closure of next states
+                closure.closeInPlace(nextStates, scratch);
+
+                // Update current states and add to path
+                std::swap(currentStates, nextStates);
+                if (trackPath) {
+                    // Show one state reached (simplified)
+                    result.path.push_back(smallestName(fa, currentStates));
+                }
+
+                result.position++;
+                if (result.decidedAt < 0 && decided(currentStates)) {
+                    settle();
+                }
+            }
+
+            if (result.decidedAt < 0) {
+                settle();
+            } else if (!trackPath && result.accepted) {
+                // Accept sink: accepted unless the rest contains a symbol outside the alphabet
+                for (int read = result.position + 1; nextToken(symbol, text); read++) {
+                    if (symbol == NO_ID) {
+                        result.error = "No valid transition for symbol '" + displayToken(text) + "' from current states";
+                        result.accepted = false;
+                        result.decidedAt = read;
+                        break;
+                    }
+                }
+            }
+
+        } catch (const std::exception& e) {
+            result.error = "Error during validation: " + std::string(e.what());
+            result.accepted = false;
+        }
+
+        return result;
+    }
+
+    const Automaton& fa;
+    Tokenizer tokenizer;
+    EpsilonClosure closure;
+    StateSet currentStates;
+    StateSet nextStates;
+    StateSet scratch;
+    StateSet accepting;
+    StateSet live;
+    StateSet sinks;
+};
+
+// Accept/reject (no path) validation on a lazily built DFA, see
+// core/LazyDFA.hpp. Reports the same accepted, final_state, error and
+// decided offset as StringValidator, at table-lookup speed once the
+// subsets the inputs visit are cached.
+//
+// When the cache thrashes (it keeps being flushed while each new state is
+// used for only a few steps) building states costs more than it saves, so
+// the remaining inputs go to the set simulation instead.
+class LazyValidator {
+public:
+    LazyValidator(const Automaton& fa, TokenMode mode, size_t cacheLimit = LazyDFA::DEFAULT_CACHE_LIMIT)
+        : fa(fa), mode(mode), tokenizer(fa.symbols.names, mode), dfa(fa, cacheLimit), scratch(fa.numStates()) {}
+
+    ValidationResult validateString(const std::string& inputString) {
+        if (fallback) {
+            return fallback->validateString(inputString, false);
+        }
+        size_t pos = 0;
+        return simulate([&](SymbolId& symbol, std::string& text) {
+            if (pos >= inputString.size()) return false;
+            size_t length = tokenizer.next(inputString, pos, symbol);
+            text.assign(inputString, pos, length);
+            pos += length;
+            return true;
+        });
+    }
+
+    ValidationResult validateTokens(const std::vector<std::string>& tokens) {
+        if (fallback) {
+            return fallback->validateTokens(tokens, false);
+        }
+        size_t i = 0;
+        return simulate([&](SymbolId& symbol, std::string& text) {
+            if (i >= tokens.size()) return false;
+            text = tokens[i++];
+            symbol = tokenizer.find(text);
+            return true;
+        });
+    }
+
+    const LazyDFA& cache() const { return dfa; }
+    bool usingFallback() const { return fallback != nullptr; }
+
+private:
+    // Flushes before thrashing is considered, and the fewest steps each
+    // built state must serve on average to keep the lazy DFA
+    static constexpr size_t THRASH_MIN_FLUSHES = 3;
+    static constexpr size_t THRASH_MIN_STEPS_PER_STATE = 10;
+
+    template <typename NextToken>
+    ValidationResult simulate(NextToken nextToken) {
+        ValidationResult result = run(nextToken);
+        steps += result.position;
+        if (dfa.flushes() >= THRASH_MIN_FLUSHES && steps < THRASH_MIN_STEPS_PER_STATE * dfa.statesBuilt()) {
+            fallback.reset(new StringValidator(fa, mode));
+        }
+        return result;
+    }
+
+    template <typename NextToken>
+    ValidationResult run(NextToken nextToken) {
+        ValidationResult result;
+        result.accepted = false;
+        result.position = 0;
+
+        // Stops once the verdict of the current state is decided
+        StateId state = dfa.start();
+        SymbolId symbol;
+        std::string text;
+        while (dfa.verdict(state) == Verdict::Open && nextToken(symbol, text)) {
+            StateId next = dfa.next(state, symbol);
+            if (next == LazyDFA::DEAD) {
+                result.error = "No valid transition for symbol '" + displayToken(text) + "' from current states";
+                result.decidedAt = result.position + 1;
+                if (result.position > 0) {
+                    result.currentState = smallestName(fa, dfa.subset(state));
+                }
+                return result;
+            }
+            state = next;
+            result.position++;
+        }
+        result.decidedAt = result.position;
+
+        // The smallest accepting state of the subset reached, else its
+        // smallest state; nothing when no symbol was read and none accepts
+        const StateSet& current = dfa.subset(state);
+        result.accepted = dfa.accepting(state);
+        if (result.accepted) {
+            scratch = current;
+            scratch &= dfa.nfaAccepting();
+            result.currentState = smallestName(fa, scratch);
+        } else if (result.position > 0) {
+            result.currentState = smallestName(fa, current);
+        }
+
+        if (dfa.verdict(state) == Verdict::Accept) {
+            // Accepted unless the rest contains a symbol outside the alphabet
+            for (int read = result.position + 1; nextToken(symbol, text); read++) {
+                if (symbol == NO_ID) {
+                    result.error = "No valid transition for symbol '" + displayToken(text) + "' from current states";
+                    result.accepted = false;
+                    result.decidedAt = read;
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    const Automaton& fa;
+    TokenMode mode;
+    Tokenizer tokenizer;
+    LazyDFA dfa;
+    StateSet scratch;
+    size_t steps = 0;
+    std::unique_ptr<StringValidator> fallback;
+};
+
+} // namespace automata
@@ -0,0 +1,532 @@
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../core/Commands.hpp"
+
+using json = nlohmann::json;
+using namespace std;
+using namespace automata;
+
+// Regression checks for the core algorithms. Random small automata are run
+// through them and every answer is compared with a brute-force reference
+// that works on the JSON document directly, on sets of state names.
+//
+//   make test                     (from cpp/)
+//   tests/RegressionTests [iterations] [seed]
+//
+// Exits non-zero and prints the offending automaton when a check fails.
+
+namespace {
+
+typedef set<string> Names;
+typedef vector<string> Word;
+
+int failures = 0;
+int checks = 0;
+
+void check(bool ok, const string& what, const json& context) {
+    checks++;
+    if (ok) return;
+    if (++failures <= 10) {
+        cerr << "FAIL " << what << "\n" << context.dump() << "\n";
+    }
+}
+
+// Random NFA over 1-3 single-letter symbols; with `deterministic` every row
+// has at most one target and there are no epsilon edges
+json randomAutomaton(mt19937& rng, bool deterministic) {
+    auto pick = [&](int n) { return static_cast<int>(rng() % n); };
+    int n = 1 + pick(5);
+    Word symbols{"a", "b", "c"};
+    symbols.resize(1 + pick(3));
+    vector<string> states;
+    for (int i = 0; i < n; i++) {
+        states.push_back("q" + to_string(i));
+    }
+
+    json transitions = json::object();
+    json endStates = json::array();
+    for (const string& state : states) {
+        json row = json::object();
+        for (const string& symbol : symbols) {
+            json targets = json::array();
+            int count = deterministic ? pick(4) > 0 : pick(3);
+            for (int t = 0; t < count; t++) {
+                targets.push_back(states[pick(n)]);
+            }
+            row[symbol] = targets;
+        }
+        if (!deterministic && pick(4) == 0) {
+            row["ɛ"] = json::array({states[pick(n)]});
+        }
+        transitions[state] = row;
+        if (pick(3) == 0) {
+            endStates.push_back(state);
+        }
+    }
+
+    // States are interned in declaration order, so IDs differ from name order
+    vector<string> declared = states;
+    shuffle(declared.begin(), declared.end(), rng);
+    json doc = {{"states", declared}, {"symbols", symbols}, {"transitions", transitions},
+                {"start_state", "q0"}, {"end_states", endStates}};
+    if (!deterministic) {
+        doc["symbols"].push_back("ɛ");
+    }
+    return doc;
+}
+
+// Brute-force reference working on the document itself
+
+Word alphabetOf(const json& doc) {
+    Word symbols;
+    for (const string& symbol : doc["symbols"].get<Word>()) {
+        if (!isEpsilon(symbol)) symbols.push_back(symbol);
+    }
+    return symbols;
+}
+
+Names targetsOf(const json& doc, const string& state, const string& symbol) {
+    Names result;
+    const json& transitions = doc["transitions"];
+    if (transitions.contains(state) && transitions[state].contains(symbol)) {
+        for (const string& target : transitions[state][symbol].get<Word>()) {
+            result.insert(target);
+        }
+    }
+    return result;
+}
+
+Names closeRef(const json& doc, Names states) {
+    vector<string> stack(states.begin(), states.end());
+    while (!stack.empty()) {
+        string state = stack.back();
+        stack.pop_back();
+        for (const char* epsilon : {"ɛ", "ε"}) {
+            for (const string& target : targetsOf(doc, state, epsilon)) {
+                if (states.insert(target).second) stack.push_back(target);
+            }
+        }
+    }
+    return states;
+}
+
+Names startRef(const json& doc) {
+    return closeRef(doc, {doc["start_state"].get<string>()});
+}
+
+Names stepRef(const json& doc, const Names& states, const string& symbol) {
+    Names next;
+    for (const string& state : states) {
+        for (const string& target : targetsOf(doc, state, symbol)) {
+            next.insert(target);
+        }
+    }
+    return closeRef(doc, next);
+}
+
+Names runRef(const json& doc, const Word& word) {
+    Names states = startRef(doc);
+    for (const string& symbol : word) {
+        states = stepRef(doc, states, symbol);
+    }
+    return states;
+}
+
+bool acceptingRef(const json& doc, const Names& states) {
+    for (const string& state : doc["end_states"].get<Word>()) {
+        if (states.count(state)) return true;
+    }
+    return false;
+}
+
+bool acceptsRef(const json& doc, const Word& word) {
+    return acceptingRef(doc, runRef(doc, word));
+}
+
+// The smallest accepting name, else the smallest name (reported only after
+// a symbol was read)
+string finalStateRef(const json& doc, const Names& states, bool read) {
+    Word ends = doc["end_states"].get<Word>();
+    for (const string& state : states) {
+        if (find(ends.begin(), ends.end(), state) != ends.end()) return state;
+    }
+    return read && !states.empty() ? *states.begin() : "";
+}
+
+// Length of a shortest word accepted by `left` and not by `right`, or -1,
+// by breadth-first search over pairs of reachable subsets
+int shortestNotIncludedRef(const json& left, const json& right) {
+    typedef pair<Names, Names> Pair;
+    vector<Pair> level{{startRef(left), startRef(right)}};
+    set<Pair> seen(level.begin(), level.end());
+    for (int length = 0; !level.empty(); length++) {
+        vector<Pair> next;
+        for (const Pair& p : level) {
+            if (acceptingRef(left, p.first) && !acceptingRef(right, p.second)) return length;
+            for (const string& symbol : alphabetOf(left)) {
+                Pair q{stepRef(left, p.first, symbol), stepRef(right, p.second, symbol)};
+                if (seen.insert(q).second) next.push_back(q);
+            }
+        }
+        level.swap(next);
+    }
+    return -1;
+}
+
+// Every word over `symbols` up to `maxLength`
+void forEachWord(const Word& symbols, size_t maxLength, const function<void(const Word&)>& visit) {
+    Word word;
+    function<void()> extend = [&]() {
+        visit(word);
+        if (word.size() == maxLength) return;
+        for (const string& symbol : symbols) {
+            word.push_back(symbol);
+            extend();
+            word.pop_back();
+        }
+    };
+    extend();
+}
+
+string joined(const Word& word) {
+    string text;
+    for (const string& symbol : word) text += symbol;
+    return text;
+}
+
+bool dfaAccepts(const NamedDFA& dfa, const Word& word) {
+    StateId state = dfa.table.start;
+    for (const string& symbol : word) {
+        if (state == DenseDFA::DEAD) return false;
+        SymbolId c = static_cast<SymbolId>(find(dfa.alphabet.begin(), dfa.alphabet.end(), symbol) - dfa.alphabet.begin());
+        state = c < dfa.alphabet.size() ? dfa.table.next(state, c) : DenseDFA::DEAD;
+    }
+    return state != DenseDFA::DEAD && dfa.table.accepting[state];
+}
+
+// Size of the minimal DFA by naive Moore refinement: every pair of states is
+// compared on every symbol until no class splits. Missing transitions go to
+// an explicit dead state, which is not counted, nor are the states
+// equivalent to it unless the start is one of them.
+size_t minimalSizeRef(const NamedDFA& dfa) {
+    const DenseDFA& t = dfa.table;
+    const StateId dead = t.numStates;
+    auto next = [&](StateId s, SymbolId c) {
+        if (s == dead) return dead;
+        StateId target = t.next(s, c);
+        return target == DenseDFA::DEAD ? dead : target;
+    };
+
+    vector<StateId> reachable{t.start};
+    vector<bool> seen(t.numStates + 1, false);
+    seen[t.start] = true;
+    bool partial = false;
+    for (size_t i = 0; i < reachable.size(); i++) {
+        for (SymbolId c = 0; c < t.numSymbols; c++) {
+            StateId target = next(reachable[i], c);
+            partial = partial || target == dead;
+            if (!seen[target]) {
+                seen[target] = true;
+                reachable.push_back(target);
+            }
+        }
+    }
+    if (partial && !seen[dead]) reachable.push_back(dead);
+
+    map<StateId, int> cls;
+    for (StateId s : reachable) {
+        cls[s] = s != dead && t.accepting[s] ? 1 : 0;
+    }
+    for (bool changed = true; changed;) {
+        map<vector<int>, int> signatures;
+        map<StateId, int> refined;
+        for (StateId s : reachable) {
+            vector<int> signature{cls[s]};
+            for (SymbolId c = 0; c < t.numSymbols; c++) {
+                signature.push_back(cls[next(s, c)]);
+            }
+            refined[s] = signatures.emplace(signature, static_cast<int>(signatures.size())).first->second;
+        }
+        changed = signatures.size() != set<int>([&] {
+            set<int> classes;
+            for (auto& entry : cls) classes.insert(entry.second);
+            return classes;
+        }()).size();
+        cls.swap(refined);
+    }
+
+    set<int> classes;
+    for (auto& entry : cls) classes.insert(entry.second);
+    if (!partial) return classes.size();
+    if (cls[t.start] == cls[dead]) return 1;
+    return classes.size() - 1;
+}
+
+// Checks
+
+// The IR lists exactly the document's targets for every state and symbol,
+// epsilon included, under the right names
+void checkCompile(const json& doc) {
+    Automaton fa = compileAutomaton(doc);
+    check(fa.states.name(fa.start) == doc["start_state"].get<string>(), "compiled start state", doc);
+    for (const auto& row : doc["transitions"].items()) {
+        StateId state = fa.states.find(row.key());
+        auto names = [&](const StateId* begin, const StateId* end) {
+            Names result;
+            for (const StateId* target = begin; target != end; ++target) result.insert(fa.states.name(*target));
+            return result;
+        };
+        for (const string& symbol : alphabetOf(doc)) {
+            SymbolId id = fa.symbols.find(symbol);
+            check(names(fa.targetsBegin(state, id), fa.targetsEnd(state, id)) == targetsOf(doc, row.key(), symbol),
+                  "compiled targets of " + row.key() + " on " + symbol, doc);
+        }
+        check(names(fa.epsilonBegin(state), fa.epsilonEnd(state)) == targetsOf(doc, row.key(), "ɛ"),
+              "compiled epsilon targets of " + row.key(), doc);
+    }
+    for (StateId state = 0; state < fa.numStates(); state++) {
+        Word ends = doc["end_states"].get<Word>();
+        bool accepting = find(ends.begin(), ends.end(), fa.states.name(state)) != ends.end();
+        check((fa.accepting[state] != 0) == accepting, "compiled accepting flag of " + fa.states.name(state), doc);
+    }
+}
+
+void checkDeterminize(const json& doc) {
+    NamedDFA dfa = determinize(compileAutomaton(doc));
+    forEachWord(alphabetOf(doc), 5, [&](const Word& word) {
+        check(dfaAccepts(dfa, word) == acceptsRef(doc, word), "determinize on '" + joined(word) + "'", doc);
+    });
+}
+
+// A state set is reported by its smallest name, the smallest accepting one
+// when it accepts
+void checkFinalState(const json& doc) {
+    Automaton fa = compileAutomaton(doc);
+    StringValidator validator(fa, TokenMode::Byte);
+    forEachWord(alphabetOf(doc), 4, [&](const Word& word) {
+        ValidationResult result = validator.validateString(joined(word), true);
+        if (!result.error.empty() || result.decidedAt != static_cast<int>(word.size())) return;
+        check(result.currentState == finalStateRef(doc, runRef(doc, word), !word.empty()), "validate final_state",
+              json{{"automaton", doc}, {"input", joined(word)}});
+    });
+}
+
+void checkMinimize(const json& doc) {
+    NamedDFA dfa = determinize(compileAutomaton(doc));
+    NamedDFA minimal = minimizeDFA(dfa);
+    forEachWord(alphabetOf(doc), 5, [&](const Word& word) {
+        check(dfaAccepts(minimal, word) == acceptsRef(doc, word), "minimize on '" + joined(word) + "'", doc);
+    });
+    check(minimal.table.numStates == minimalSizeRef(dfa), "minimize is minimal", doc);
+}
+
+void checkProduct(const json& left, const json& right) {
+    NamedDFA a = toDFA(compileAutomaton(left));
+    NamedDFA b = toDFA(compileAutomaton(right));
+    Word symbols = alphabetOf(left);
+    for (const string& symbol : alphabetOf(right)) {
+        if (find(symbols.begin(), symbols.end(), symbol) == symbols.end()) symbols.push_back(symbol);
+    }
+    for (const char* name : {"intersection", "union", "difference", "xor"}) {
+        ProductOp op = parseProductOp(name);
+        NamedDFA product = productDFA(a, b, op);
+        forEachWord(symbols, 4, [&](const Word& word) {
+            bool expected = productAccepts(op, acceptsRef(left, word), acceptsRef(right, word));
+            check(dfaAccepts(product, word) == expected, string(name) + " on '" + joined(word) + "'",
+                  json{{"left", left}, {"right", right}});
+        });
+    }
+}
+
+void checkEquivalenceAndInclusion(const json& left, const json& right) {
+    json pair = {{"left", left}, {"right", right}};
+    Automaton a = compileAutomaton(left);
+    Automaton b = compileAutomaton(right);
+    int forward = shortestNotIncludedRef(left, right);
+    int backward = shortestNotIncludedRef(right, left);
+    int shortest = forward < 0 ? backward : backward < 0 ? forward : min(forward, backward);
+
+    InclusionResult inclusion = nfaInclusion(a, b);
+    check(inclusion.included == (forward < 0), "inclusion", pair);
+    if (!inclusion.included) {
+        check(acceptsRef(left, inclusion.counterexample) && !acceptsRef(right, inclusion.counterexample),
+              "inclusion counterexample", pair);
+    }
+
+    // Union-find counterexamples are shortest; antichain ones need not be
+    EquivalenceResult unionFind = dfaEquivalence(toDFA(a), toDFA(b));
+    EquivalenceResult antichain = nfaEquivalence(a, b);
+    for (const EquivalenceResult* result : {&unionFind, &antichain}) {
+        check(result->equivalent == (shortest < 0), "equivalence", pair);
+        if (result->equivalent) continue;
+        const Word& word = result->counterexample;
+        check(acceptsRef(left, word) == result->acceptedByLeft && acceptsRef(right, word) != result->acceptedByLeft,
+              "equivalence counterexample", pair);
+    }
+    if (!unionFind.equivalent) {
+        check(static_cast<int>(unionFind.counterexample.size()) == shortest, "shortest counterexample", pair);
+    }
+}
+
+void checkSearch(const json& doc, mt19937& rng) {
+    Word symbols = alphabetOf(doc);
+    string text;
+    for (int i = static_cast<int>(rng() % 12); i > 0; i--) {
+        // 'x' is outside every alphabet
+        text += rng() % 5 == 0 ? string("x") : symbols[rng() % symbols.size()];
+    }
+    auto matchesAt = [&](size_t start, size_t end) {
+        Word word;
+        for (size_t i = start; i < end; i++) word.push_back(string(1, text[i]));
+        return acceptsRef(doc, word);
+    };
+
+    Searcher searcher(compileAutomaton(doc), true);
+    json context = {{"automaton", doc}, {"text", text}};
+
+    vector<size_t> ends;
+    searcher.forEachEnd(text.data(), text.size(), [&](size_t end) { ends.push_back(end); });
+    vector<size_t> expectedEnds;
+    for (size_t end = 0; end <= text.size(); end++) {
+        for (size_t start = 0; start <= end; start++) {
+            if (matchesAt(start, end)) {
+                expectedEnds.push_back(end);
+                break;
+            }
+        }
+    }
+    check(ends == expectedEnds, "search match ends", context);
+
+    vector<pair<size_t, size_t>> matches;
+    searcher.forEachMatch(text.data(), text.size(), [&](Match m) { matches.push_back({m.start, m.end}); });
+    vector<pair<size_t, size_t>> expectedMatches;
+    for (size_t pos = 0; pos <= text.size();) {
+        bool found = false;
+        for (size_t start = pos; start <= text.size() && !found; start++) {
+            for (size_t end = text.size() + 1; end-- > start;) {
+                if (matchesAt(start, end)) {
+                    expectedMatches.push_back({start, end});
+                    pos = end > start ? end : start + 1;
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found) break;
+    }
+    check(matches == expectedMatches, "search leftmost-longest matches", context);
+}
+
+// Everything but the path must be the same with and without trackPath, also
+// past a symbol outside the alphabet ('x'). Batch requests, whichever of the
+// DFA runner and the lazy DFA serves them, must agree with single ones.
+void checkValidation(const json& doc) {
+    Automaton fa = compileAutomaton(doc);
+    StringValidator validator(fa, TokenMode::Byte);
+    Word symbols = alphabetOf(doc);
+    symbols.push_back("x");
+
+    json request = doc;
+    request["inputs"] = json::array();
+    json tokenRequest = request;
+    vector<json> singles;
+    forEachWord(symbols, 4, [&](const Word& word) {
+        json single = doc;
+        single["input"] = joined(word);
+        singles.push_back(validateRequest(single));
+        request["inputs"].push_back(joined(word));
+        tokenRequest["inputs"].push_back(word);
+    });
+    json batch = validateRequest(request);
+    json tokenBatch = validateRequest(tokenRequest);
+    for (size_t i = 0; i < singles.size(); i++) {
+        for (const json* results : {&batch["results"], &tokenBatch["results"]}) {
+            const json& entry = (*results)[i];
+            json context = {{"automaton", doc}, {"single", singles[i]}, {"batch", entry}};
+            check(entry["accepted"] == singles[i]["accepted"] && entry["final_state"] == singles[i]["final_state"] &&
+                      entry["decided_at"] == singles[i]["decided_at"] &&
+                      entry.value("error", "") == singles[i].value("error", ""),
+                  "batch against single validation", context);
+        }
+    }
+
+    forEachWord(symbols, 4, [&](const Word& word) {
+        string input = joined(word);
+        ValidationResult withPath = validator.validateString(input, true);
+        ValidationResult withoutPath = validator.validateString(input, false);
+        json context = {{"automaton", doc}, {"input", input}};
+        bool known = find(word.begin(), word.end(), "x") == word.end();
+        check(withPath.accepted == (known && acceptsRef(doc, word)), "validate", context);
+        check(withoutPath.accepted == withPath.accepted && withoutPath.currentState == withPath.currentState &&
+                  withoutPath.error == withPath.error && withoutPath.decidedAt == withPath.decidedAt,
+              "validate without path", context);
+    });
+}
+
+// Once decided, the rest of the input only matters through symbols outside
+// the alphabet ('x'), and not at all after a rejection
+void checkEarlyStop(const json& doc) {
+    Automaton fa = compileAutomaton(doc);
+    StringValidator validator(fa, TokenMode::Byte);
+    Word symbols = alphabetOf(doc);
+    symbols.push_back("x");
+
+    forEachWord(symbols, 4, [&](const Word& word) {
+        string input = joined(word);
+        ValidationResult result = validator.validateString(input, false);
+        if (!result.error.empty() || result.decidedAt >= static_cast<int>(word.size())) return;
+
+        json context = {{"automaton", doc}, {"input", input}};
+        Word head(word.begin(), word.begin() + result.decidedAt);
+        ValidationResult prefix = validator.validateString(joined(head), false);
+        check(prefix.accepted == result.accepted && prefix.currentState == result.currentState &&
+                  prefix.decidedAt == result.decidedAt,
+              "validate stops once decided", context);
+        if (!result.accepted) {
+            ValidationResult tail = validator.validateString(input + "x", false);
+            check(tail.error.empty() && tail.decidedAt == result.decidedAt,
+                  "validate ignores the rest after a rejection", context);
+        }
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 300;
+    mt19937 rng(argc > 2 ? static_cast<unsigned>(atoi(argv[2])) : 1u);
+
+    for (int i = 0; i < iterations; i++) {
+        json left = randomAutomaton(rng, rng() % 3 == 0);
+        json right = randomAutomaton(rng, rng() % 3 == 0);
+        if (rng() % 3 == 0) {
+            // An equivalent automaton, so the equivalent case is exercised too
+            right = automatonToJson(toAutomaton(minimizeDFA(determinize(compileAutomaton(left)))));
+        }
+
+        try {
+            checkCompile(left);
+            checkDeterminize(left);
+            checkMinimize(left);
+            checkProduct(left, right);
+            checkEquivalenceAndInclusion(left, right);
+            checkSearch(left, rng);
+            checkFinalState(left);
+            checkValidation(left);
+            checkEarlyStop(left);
+        } catch (const exception& e) {
+            check(false, string("exception: ") + e.what(), json{{"left", left}, {"right", right}});
+        }
+    }
+
+    cout << checks - failures << " of " << checks << " checks passed" << endl;
+    return failures == 0 ? 0 : 1;
+}